@@ -5,6 +5,9 @@
 /**
  * @example Get-info.ino This example shows data about TR module.
  */
+/**
+ * @example CRC-benchmark.ino This example compares CRC calculation by byte loop and streaming CRC.
+ */
 
 
 // Sections
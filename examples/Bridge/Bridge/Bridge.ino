@@ -0,0 +1,81 @@
+/**
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <IQRF.h>
+
+// LOCAL PROTOTYPES
+void setup();
+void loop();
+void rxHandler(const uint8_t *data, uint8_t dataLength);
+void txHandler(uint8_t packetId, uint8_t packetResult);
+
+/// Instances
+IQRF iqrf;
+IQRFBridge bridge;
+
+/**
+ * Init peripherals
+ */
+void setup() {
+	// Up - PC, framed packets only
+	Serial.begin(115200);
+	// Wait for Serial
+	while (!Serial) {
+	}
+	// Down - IQRF, received data are passed to the bridge without copying
+	// Serial carries frames only, driver messages are not printed
+	iqrf.disableLog();
+	iqrf.begin(rxHandler, txHandler);
+	iqrf.enableBurstMode();
+	// Host starts sending after READY frame
+	bridge.begin(&iqrf, &Serial);
+}
+
+/**
+ * Main loop
+ */
+void loop() {
+	// TR module SPI comunication driver
+	iqrf.driver();
+	// Serial line to TR module and back
+	bridge.task();
+}
+
+/**
+ * IQRF Rx callback
+ * @param data Received data, the bridge releases them
+ * @param dataLength Length of received data
+ */
+void rxHandler(const uint8_t *data, uint8_t dataLength) {
+	bridge.rxDone(data, dataLength);
+}
+
+/**
+ * IQRF Tx callback
+ * @param packetId Packet ID
+ * @param packetResult Packet writing result
+ */
+void txHandler(uint8_t packetId, uint8_t packetResult) {
+	bridge.txDone(packetId, packetResult);
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <IQRF.h>
+
+// Count of measured iterations
+#define BENCHMARK_ITERATIONS 1000
+// Length of data in measured packet
+#define DATA_LENGTH 64
+
+// LOCAL PROTOTYPES
+void setup();
+void loop();
+void printResult(const char *name, uint32_t time);
+
+// GLOBAL VARIABLES
+IQRFCRC crc;
+uint8_t frame[DATA_LENGTH + 3];
+volatile uint8_t sink;
+
+/**
+ * Init peripherals
+ */
+void setup() {
+	Serial.begin(9600);
+#if defined(__AVR_ATmega32U4__) || defined(CORE_TEENSY)
+	while (!Serial) {
+	}
+#endif
+	// SPI packet received from TR module: CMD, PTYPE, data, CRCS
+	frame[0] = IQRFSPI::WR_RD;
+	frame[1] = DATA_LENGTH | 0x80;
+	for (uint8_t i = 0; i < DATA_LENGTH; i++) {
+		frame[i + 2] = i * 7 + 1;
+	}
+	// CRCS does not cover CMD
+	frame[DATA_LENGTH + 2] = crc.calculate(frame, DATA_LENGTH) ^ frame[0];
+}
+
+/**
+ * Main loop
+ */
+void loop() {
+	uint32_t start;
+	uint8_t type = frame[1];
+	Serial.print("CRC of ");
+	Serial.print(DATA_LENGTH);
+	Serial.print(" B packet, ");
+	Serial.print(BENCHMARK_ITERATIONS);
+	Serial.println(" iterations");
+	// byte loop, both CRCs are calculated between frames
+	start = micros();
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		sink = crc.calculate(frame, DATA_LENGTH);
+		sink = crc.check(frame, DATA_LENGTH, type);
+	}
+	printResult("Byte loop (CRCM + CRCS): ", micros() - start);
+	// data folded when the packet is enqueued
+	start = micros();
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		sink = crc.fold(&frame[2], DATA_LENGTH);
+	}
+	printResult("fold() on enqueue:       ", micros() - start);
+	// CRCS folded byte by byte in pauses between bytes
+	start = micros();
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		crc.begin(type);
+		for (uint8_t j = 2; j < DATA_LENGTH + 2; j++) {
+			crc.update(frame[j]);
+		}
+	}
+	printResult("update() during transfer: ", micros() - start);
+	// only this part remains between frames
+	uint8_t dataCrc = crc.fold(&frame[2], DATA_LENGTH);
+	crc.begin(type);
+	crc.update(dataCrc);
+	start = micros();
+	for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		sink = crc.calculate(frame[0], type, dataCrc);
+		sink = crc.isValid(frame[DATA_LENGTH + 2]);
+	}
+	printResult("Streaming (CRCM + CRCS): ", micros() - start);
+	Serial.println();
+	delay(5000);
+}
+
+/**
+ * Print time of one call
+ * @param name Name of measured part
+ * @param time Time of all iterations in us
+ */
+void printResult(const char *name, uint32_t time) {
+	Serial.print(name);
+	Serial.print(time * (1000 / BENCHMARK_ITERATIONS));
+	Serial.println(" ns");
+}
@@ -64,7 +64,7 @@ appVarsStruct appVars;
 
 /// Instances
 IQRF iqrf;
-IQRFTR iqrfTr;
+IQRFTR &iqrfTr = iqrf.getTr();
 
 /**
  * Init peripherals
@@ -0,0 +1,389 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SimTR.h"
+
+#include "IQRFSPI.h"
+#include "IQRFTR.h"
+
+/**
+ * Constructor
+ * @param ssPin SS pin
+ * @param resetPin Reset (power) pin
+ */
+SimTR::SimTR(uint8_t ssPin, uint8_t resetPin) : ssPin(ssPin), resetPin(resetPin) {
+	memset(this->eeprom, 0, sizeof(this->eeprom));
+	memset(this->ram, 0, sizeof(this->ram));
+	this->powered = true;
+	this->powerOnUs = 0;
+	this->mirrorWrites = 0;
+	this->spiUsed = true;
+	this->mode = IQRFSPI::statuses::COMMUNICATION_MODE;
+	const uint8_t info[] = {0x81, 0x00, 0x12, 0x34, 0x43, 0x00, 0x08, 0x00};
+	memcpy(this->info, info, sizeof(this->info));
+	this->setModuleType(IQRFTR::types::TR_72D);
+	this->busyUntilUs = 0;
+	this->processUs = 0;
+	this->echo = false;
+	this->readInProgramMode = true;
+	this->outLength = 0;
+	this->index = 0;
+	this->lastLength = 0;
+	this->writtenCount = 0;
+	this->readCount = 0;
+	this->crcmErrors = 0;
+	this->programEntries = 0;
+	this->eepromWrites = 0;
+}
+
+/**
+ * Get SS pin of the module
+ * @return SS pin
+ */
+uint8_t SimTR::getSsPin() {
+	return this->ssPin;
+}
+
+/**
+ * Exchange one byte of SPI packet
+ * @param mosi Byte from master
+ * @return Byte to master
+ */
+uint8_t SimTR::transfer(uint8_t mosi) {
+	if (!this->powered) {
+		return IQRFSPI::statuses::NO_MODULE;
+	}
+	if (!this->spiUsed) {
+		this->spiUsed = true;
+		if (this->mirrorWrites > 0 && Simulation::now() - this->powerOnUs >= 400000UL) {
+			this->mode = IQRFSPI::statuses::PROGRAMMING_MODE;
+			this->programEntries++;
+		}
+	}
+	if (this->index == 0) {
+		uint8_t status = this->getStatus();
+		if (mosi == IQRFSPI::commands::CHECK) {
+			return status;
+		}
+		// packet is accepted only by ready module or by module with data for master
+		if (status == this->mode || (status & 0xC0) == 0x40) {
+			this->startFrame(mosi);
+			this->frameStatus = status;
+			this->index = 1;
+		}
+		return status;
+	}
+	if (this->index == 1) {
+		this->ptype = mosi;
+		this->length = mosi & 0x7F;
+		if (this->length > sizeof(this->in)) {
+			this->length = sizeof(this->in);
+		}
+		this->crcm = 0x5F ^ this->cmd ^ mosi;
+		this->crcs = 0x5F ^ mosi;
+		this->index = 2;
+		return 0;
+	}
+	if (this->index < this->length + 2) {
+		uint8_t i = this->index - 2;
+		this->in[i] = mosi;
+		this->crcm ^= mosi;
+		uint8_t miso = this->dataByte(i, mosi);
+		this->crcs ^= miso;
+		this->index++;
+		return miso;
+	}
+	if (this->index == this->length + 2) {
+		this->crcmValid = (mosi == this->crcm);
+		this->index++;
+		return this->crcs;
+	}
+	this->index = 0;
+	bool valid = this->crcmValid;
+	this->finishFrame();
+	return valid ? IQRFSPI::statuses::CRCM_OK : IQRFSPI::statuses::CRCM_ERR;
+}
+
+/**
+ * Output pin of MCU was changed
+ * @param pin Pin
+ * @param value New level
+ */
+void SimTR::pinChanged(uint8_t pin, uint8_t value) {
+	if (pin == this->resetPin) {
+		if (value == HIGH) {
+			this->powered = false;
+			this->index = 0;
+			this->outLength = 0;
+			this->busyUntilUs = 0;
+			this->mode = IQRFSPI::statuses::COMMUNICATION_MODE;
+		} else if (!this->powered) {
+			this->powered = true;
+			this->powerOnUs = Simulation::now();
+			this->mirrorWrites = 0;
+			this->spiUsed = false;
+		}
+	} else if (pin == TR_MOSI_PIN && this->powered && !this->spiUsed && Simulation::getPinLevel(this->ssPin) == LOW) {
+		this->mirrorWrites++;
+	}
+}
+
+/**
+ * Get level of MISO pin driven by the module outside of SPI packets
+ * @return Level or -1 if MISO is not driven
+ */
+int SimTR::misoLevel() {
+	if (this->powered && !this->spiUsed) {
+		return (Simulation::now() / 50) & 1;
+	}
+	return -1;
+}
+
+/**
+ * Set type of the module
+ * @param moduleType Module type (IQRFTR::types)
+ */
+void SimTR::setModuleType(uint8_t moduleType) {
+	this->info[5] = (this->info[5] & 0x0F) | (moduleType << 4);
+}
+
+/**
+ * Set time of processing of written packet, buffer COM is full for this time
+ * @param us Time in us
+ */
+void SimTR::setProcessTime(unsigned long us) {
+	this->processUs = us;
+}
+
+/**
+ * Return written data back to master as received data
+ */
+void SimTR::enableEcho() {
+	this->echo = true;
+}
+
+/**
+ * Set if EEPROM_READ and RAM_READ work in programming mode, otherwise MOSI is echoed
+ * @param supported Reading works
+ */
+void SimTR::setReadInProgramMode(bool supported) {
+	this->readInProgramMode = supported;
+}
+
+/**
+ * Set mode of the module
+ * @param mode SPI status of mode
+ */
+void SimTR::setMode(uint8_t mode) {
+	this->mode = mode;
+}
+
+/**
+ * Get mode of the module
+ * @return SPI status of mode
+ */
+uint8_t SimTR::getMode() {
+	return this->mode;
+}
+
+/**
+ * Prepare data for master
+ * @param data Data
+ * @param dataLength Data length
+ * @return Data were accepted
+ */
+bool SimTR::inject(const uint8_t *data, uint8_t dataLength) {
+	if (this->outLength || dataLength == 0 || dataLength > sizeof(this->out)) {
+		return false;
+	}
+	memcpy(this->out, data, dataLength);
+	this->outLength = dataLength;
+	return true;
+}
+
+/**
+ * Get SPI status of the module
+ * @return SPI status
+ */
+uint8_t SimTR::getStatus() {
+	if (!this->powered) {
+		return IQRFSPI::statuses::NO_MODULE;
+	}
+	if ((long) (Simulation::now() - this->busyUntilUs) < 0) {
+		return IQRFSPI::statuses::CRCM_OK;
+	}
+	if (this->outLength) {
+		return 0x40 | (this->outLength & 0x3F);
+	}
+	return this->mode;
+}
+
+/**
+ * Get count of written packets
+ * @return Count of WR_RD writes
+ */
+unsigned long SimTR::getWrittenCount() {
+	return this->writtenCount;
+}
+
+/**
+ * Get count of read packets
+ * @return Count of WR_RD reads
+ */
+unsigned long SimTR::getReadCount() {
+	return this->readCount;
+}
+
+/**
+ * Get count of packets with CRCM error
+ * @return Count of CRCM errors
+ */
+unsigned long SimTR::getCrcmErrorCount() {
+	return this->crcmErrors;
+}
+
+/**
+ * Get count of programming mode entries
+ * @return Count of entries
+ */
+unsigned long SimTR::getProgramEntryCount() {
+	return this->programEntries;
+}
+
+/**
+ * Get count of EEPROM programming packets
+ * @return Count of EEPROM_PGM packets except of programming mode end
+ */
+unsigned long SimTR::getEepromWriteCount() {
+	return this->eepromWrites;
+}
+
+/**
+ * Get last written data
+ * @param dataLength Data length
+ * @return Data
+ */
+const uint8_t* SimTR::getLastWritten(uint8_t *dataLength) {
+	*dataLength = this->lastLength;
+	return this->last;
+}
+
+/**
+ * Start SPI packet
+ * @param cmd Command
+ */
+void SimTR::startFrame(uint8_t cmd) {
+	this->cmd = cmd;
+	this->ptype = 0;
+	this->length = 0;
+	this->crcmValid = false;
+}
+
+/**
+ * Get data byte for master
+ * @param index Index of data byte
+ * @param mosi Data byte from master
+ * @return Data byte to master
+ */
+uint8_t SimTR::dataByte(uint8_t index, uint8_t mosi) {
+	switch (this->cmd) {
+		case IQRFSPI::commands::WR_RD:
+			if (!(this->ptype & 0x80)) {
+				return (index < this->outLength) ? this->out[index] : 0;
+			}
+			return 0;
+		case IQRFSPI::commands::MODULE_INFO:
+			if (this->mode == IQRFSPI::statuses::COMMUNICATION_MODE) {
+				return (index < sizeof(this->info)) ? this->info[index] : 0;
+			}
+			return 0;
+		case IQRFSPI::commands::EEPROM_READ:
+		case IQRFSPI::commands::RAM_READ:
+			if (this->mode == IQRFSPI::statuses::DEBUG_MODE || (this->mode == IQRFSPI::statuses::PROGRAMMING_MODE && this->readInProgramMode)) {
+				if (index < 2) {
+					return 0;
+				}
+				uint16_t address = this->in[0] | (this->in[1] << 8);
+				const uint8_t *memory = (this->cmd == IQRFSPI::commands::EEPROM_READ) ? this->eeprom : this->ram;
+				return memory[(address + index - 2) % sizeof(this->eeprom)];
+			}
+			// unsupported command, shift register returns MOSI
+			return mosi;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Process completed SPI packet
+ */
+void SimTR::finishFrame() {
+	if (!this->crcmValid) {
+		this->crcmErrors++;
+		return;
+	}
+	bool write = this->ptype & 0x80;
+	switch (this->cmd) {
+		case IQRFSPI::commands::WR_RD:
+			if (write) {
+				this->writtenCount++;
+				memcpy(this->last, this->in, this->length);
+				this->lastLength = this->length;
+				this->busyUntilUs = Simulation::now() + this->processUs;
+				if (this->echo) {
+					this->inject(this->in, this->length);
+				}
+			} else if (this->frameStatus & 0x40) {
+				this->readCount++;
+				this->outLength = 0;
+			}
+			break;
+		case IQRFSPI::commands::MODULE_INFO:
+			if (write && this->mode == IQRFSPI::statuses::PROGRAMMING_MODE) {
+				uint8_t data[32];
+				memset(data, 0, sizeof(data));
+				memcpy(data, this->info, sizeof(this->info));
+				this->inject(data, sizeof(data));
+			} else if (!write && (this->frameStatus & 0x40)) {
+				this->outLength = 0;
+			}
+			break;
+		case IQRFSPI::commands::EEPROM_PGM:
+			if (this->length == 3 && this->in[0] == 0xDE && this->in[1] == 0x01 && this->in[2] == 0xFF) {
+				this->mode = IQRFSPI::statuses::COMMUNICATION_MODE;
+			} else if (this->mode == IQRFSPI::statuses::PROGRAMMING_MODE && this->length > 2) {
+				uint16_t address = this->in[0] | (this->in[1] << 8);
+				for (uint8_t i = 2; i < this->length; i++) {
+					this->eeprom[(address + i - 2) % sizeof(this->eeprom)] = this->in[i];
+				}
+				this->eepromWrites++;
+				this->busyUntilUs = Simulation::now() + this->processUs;
+			}
+			break;
+		case IQRFSPI::commands::FLASH_PGM:
+		case IQRFSPI::commands::PLUGIN_PGM:
+			if (this->mode == IQRFSPI::statuses::PROGRAMMING_MODE) {
+				this->writtenCount++;
+				this->busyUntilUs = Simulation::now() + this->processUs;
+			}
+			break;
+	}
+}
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SimTR_h
+#define SimTR_h
+
+#include <Arduino.h>
+#include <Simulation.h>
+
+#include "IQRFSettings.h"
+
+/**
+ * Simulated TR module on SPI bus
+ * SPI packets (CMD, PTYPE, data, CRCM, status) are parsed byte by byte, so SS may be released
+ * between bytes. Programming mode is entered when MOSI is written while SS is active for 400 ms
+ * after power on, like MISO to MOSI mirroring of IQRFTR
+ */
+class SimTR : public SimDevice {
+public:
+	SimTR(uint8_t ssPin, uint8_t resetPin);
+	uint8_t getSsPin();
+	uint8_t transfer(uint8_t mosi);
+	void pinChanged(uint8_t pin, uint8_t value);
+	int misoLevel();
+	void setModuleType(uint8_t moduleType);
+	void setProcessTime(unsigned long us);
+	void enableEcho();
+	void setReadInProgramMode(bool supported);
+	void setMode(uint8_t mode);
+	uint8_t getMode();
+	bool inject(const uint8_t *data, uint8_t dataLength);
+	uint8_t getStatus();
+	unsigned long getWrittenCount();
+	unsigned long getReadCount();
+	unsigned long getCrcmErrorCount();
+	unsigned long getProgramEntryCount();
+	unsigned long getEepromWriteCount();
+	const uint8_t* getLastWritten(uint8_t *dataLength);
+	/// EEPROM of TR module
+	uint8_t eeprom[0x200];
+	/// RAM of TR module
+	uint8_t ram[0x200];
+private:
+	void startFrame(uint8_t cmd);
+	uint8_t dataByte(uint8_t index, uint8_t mosi);
+	void finishFrame();
+	/// SS pin
+	uint8_t ssPin;
+	/// Reset (power) pin
+	uint8_t resetPin;
+	/// TR module is powered
+	bool powered;
+	/// Time of power on in us
+	unsigned long powerOnUs;
+	/// MOSI writes while SS is active after power on
+	unsigned long mirrorWrites;
+	/// SPI was used after power on
+	bool spiUsed;
+	/// SPI status of mode (COMMUNICATION_MODE, PROGRAMMING_MODE, DEBUG_MODE)
+	uint8_t mode;
+	/// Module info
+	uint8_t info[8];
+	/// Buffer COM is full until this time in us
+	unsigned long busyUntilUs;
+	/// Time of processing of written packet in us
+	unsigned long processUs;
+	/// Written data are returned as received data
+	bool echo;
+	/// EEPROM_READ and RAM_READ work in programming mode
+	bool readInProgramMode;
+	/// Data for master
+	uint8_t out[64];
+	/// Length of data for master
+	uint8_t outLength;
+	/// Byte index in actual packet
+	uint8_t index;
+	/// SPI status returned on the command of actual packet
+	uint8_t frameStatus;
+	/// Command of actual packet
+	uint8_t cmd;
+	/// PTYPE of actual packet
+	uint8_t ptype;
+	/// Data length of actual packet
+	uint8_t length;
+	/// Data from master
+	uint8_t in[64];
+	/// CRCM folded from received bytes
+	uint8_t crcm;
+	/// CRCS folded from sent data
+	uint8_t crcs;
+	/// Received CRCM was valid
+	bool crcmValid;
+	/// Last written data
+	uint8_t last[64];
+	/// Length of last written data
+	uint8_t lastLength;
+	/// Count of written packets
+	unsigned long writtenCount;
+	/// Count of read packets
+	unsigned long readCount;
+	/// Count of CRCM errors
+	unsigned long crcmErrors;
+	/// Count of programming mode entries
+	unsigned long programEntries;
+	/// Count of EEPROM programming packets
+	unsigned long eepromWrites;
+};
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "SPI.h"
+#include "Simulation.h"
+
+#include "IQSPI.h"
+
+/// Maximal count of devices on simulated SPI bus
+#define SIM_DEVICES 8
+
+/// Virtual time in us
+static unsigned long simUs = 0;
+/// Levels of MCU pins
+static uint8_t pinLevels[256];
+/// Devices on SPI bus
+static SimDevice *devices[SIM_DEVICES];
+/// Count of devices on SPI bus
+static uint8_t deviceCount = 0;
+/// SPI bus is enabled
+static bool spiEnabled = false;
+/// Counters of SPI bus
+static simCounters_t counters;
+/// State of random generator
+static unsigned long randomState = 1;
+
+HardwareSerial Serial;
+SPIClass SPI;
+EEPROMClass EEPROM;
+
+/**
+ * Attach device to SPI bus
+ * @param device Device
+ */
+void Simulation::attach(SimDevice *device) {
+	if (deviceCount < SIM_DEVICES) {
+		devices[deviceCount++] = device;
+		pinLevels[device->getSsPin()] = HIGH;
+	}
+}
+
+/**
+ * Detach all devices from SPI bus
+ */
+void Simulation::detachAll() {
+	deviceCount = 0;
+}
+
+/**
+ * Get virtual time without advancing it
+ * @return Virtual time in us
+ */
+unsigned long Simulation::now() {
+	return simUs;
+}
+
+/**
+ * Advance virtual time
+ * @param us Time in us
+ */
+void Simulation::advance(unsigned long us) {
+	simUs += us;
+}
+
+/**
+ * Reset counters of SPI bus
+ */
+void Simulation::resetCounters() {
+	memset(&counters, 0, sizeof(counters));
+}
+
+/**
+ * Get counters of SPI bus
+ * @return Counters
+ */
+simCounters_t& Simulation::getCounters() {
+	return counters;
+}
+
+/**
+ * Get level of MCU pin
+ * @param pin Pin
+ * @return Level
+ */
+uint8_t Simulation::getPinLevel(uint8_t pin) {
+	return pinLevels[pin];
+}
+
+/**
+ * Check if SPI bus is enabled
+ * @return SPI.begin() was called after last SPI.end()
+ */
+bool Simulation::isSpiEnabled() {
+	return spiEnabled;
+}
+
+unsigned long micros() {
+	return ++simUs;
+}
+
+unsigned long millis() {
+	return ++simUs / 1000;
+}
+
+void delay(unsigned long ms) {
+	simUs += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+	counters.delayCalls++;
+	counters.delayUs += us;
+	simUs += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	if (pinLevels[pin] == value) {
+		return;
+	}
+	pinLevels[pin] = value;
+	for (uint8_t i = 0; i < deviceCount; i++) {
+		if (devices[i]->getSsPin() == pin) {
+			counters.ssEdges++;
+		}
+		devices[i]->pinChanged(pin, value);
+	}
+}
+
+int digitalRead(uint8_t pin) {
+	if (pin == TR_MISO_PIN) {
+		for (uint8_t i = 0; i < deviceCount; i++) {
+			int level = devices[i]->misoLevel();
+			if (pinLevels[devices[i]->getSsPin()] == LOW && level >= 0) {
+				return level;
+			}
+		}
+	}
+	return pinLevels[pin];
+}
+
+long random(long max) {
+	randomState = randomState * 1103515245UL + 12345UL;
+	return max > 0 ? (long) ((randomState >> 16) % (unsigned long) max) : 0;
+}
+
+long random(long min, long max) {
+	return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+	randomState = seed;
+}
+
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+	size_t written = 0;
+	while (size--) {
+		written += this->write(*buffer++);
+	}
+	return written;
+}
+
+int Print::availableForWrite() {
+	return 0;
+}
+
+size_t Print::print(const char *text) {
+	return this->write((const uint8_t *) text, strlen(text));
+}
+
+size_t Print::print(unsigned long value) {
+	char text[24];
+	snprintf(text, sizeof(text), "%lu", value);
+	return this->print(text);
+}
+
+size_t Print::println(const char *text) {
+	return this->print(text) + this->println();
+}
+
+size_t Print::println(unsigned long value) {
+	return this->print(value) + this->println();
+}
+
+size_t Print::println() {
+	return this->print("\r\n");
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+	fputc(value, stderr);
+	return 1;
+}
+
+int HardwareSerial::availableForWrite() {
+	return 64;
+}
+
+int HardwareSerial::available() {
+	return 0;
+}
+
+int HardwareSerial::read() {
+	return -1;
+}
+
+int HardwareSerial::peek() {
+	return -1;
+}
+
+void SPIClass::begin() {
+	spiEnabled = true;
+}
+
+void SPIClass::end() {
+	counters.spiEnds++;
+	spiEnabled = false;
+}
+
+void SPIClass::beginTransaction(SPISettings settings) {
+	counters.transactions++;
+}
+
+void SPIClass::endTransaction() {
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+	counters.spiBytes++;
+	simUs += 8UL * MICRO_SECOND / IQSPI_CLOCK;
+	if (!spiEnabled) {
+		counters.disabledTransfers++;
+		return 0xFF;
+	}
+	SimDevice *selected = NULL;
+	for (uint8_t i = 0; i < deviceCount; i++) {
+		if (pinLevels[devices[i]->getSsPin()] == LOW) {
+			if (selected != NULL) {
+				counters.conflicts++;
+				return 0xFF;
+			}
+			selected = devices[i];
+		}
+	}
+	// MISO is pulled up when no device is selected
+	return (selected != NULL) ? selected->transfer(data) : 0xFF;
+}
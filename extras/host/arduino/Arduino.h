@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Host build of Arduino core used by the simulation in extras/host
+ * Time is virtual, see Simulation.h
+ */
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT  0x0
+#define OUTPUT 0x1
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+void noInterrupts();
+void interrupts();
+
+/**
+ * Output stream
+ */
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t value) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	virtual int availableForWrite();
+	size_t print(const char *text);
+	size_t print(unsigned long value);
+	size_t println(const char *text);
+	size_t println(unsigned long value);
+	size_t println();
+};
+
+/**
+ * Input and output stream
+ */
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+/**
+ * Serial line of the host build, written text goes to stderr
+ */
+class HardwareSerial : public Stream {
+public:
+	void begin(unsigned long baud);
+	size_t write(uint8_t value);
+	int availableForWrite();
+	int available();
+	int read();
+	int peek();
+	operator bool() {
+		return true;
+	}
+};
+
+extern HardwareSerial Serial;
+
+#endif
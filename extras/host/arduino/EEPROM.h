@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stdint.h>
+
+/**
+ * EEPROM of the host build, it is kept in memory
+ */
+class EEPROMClass {
+public:
+	uint8_t read(int address) {
+		return this->data[address & 0x3FF];
+	}
+	void write(int address, uint8_t value) {
+		this->data[address & 0x3FF] = value;
+	}
+	void update(int address, uint8_t value) {
+		this->write(address, value);
+	}
+private:
+	/// Content of EEPROM
+	uint8_t data[1024];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
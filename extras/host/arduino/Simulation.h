@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef Simulation_h
+#define Simulation_h
+
+#include <stdint.h>
+
+/**
+ * Device on simulated SPI bus, it is selected by its SS pin
+ */
+class SimDevice {
+public:
+	virtual ~SimDevice() {}
+	/**
+	 * Get SS pin of the device
+	 * @return SS pin
+	 */
+	virtual uint8_t getSsPin() = 0;
+	/**
+	 * Exchange one byte with SPI master
+	 * @param mosi Byte from master
+	 * @return Byte to master
+	 */
+	virtual uint8_t transfer(uint8_t mosi) = 0;
+	/**
+	 * Output pin of MCU was changed
+	 * @param pin Pin
+	 * @param value New level
+	 */
+	virtual void pinChanged(uint8_t pin, uint8_t value) {}
+	/**
+	 * Get level driven by the device to MISO pin outside of SPI transfers
+	 * @return Level or -1 if the device does not drive MISO
+	 */
+	virtual int misoLevel() {
+		return -1;
+	}
+};
+
+/**
+ * Counters of simulated SPI bus
+ */
+typedef struct {
+	unsigned long ssEdges; //!< Level changes of SS pins of attached devices
+	unsigned long transactions; //!< SPI.beginTransaction() calls
+	unsigned long spiBytes; //!< Bytes clocked on SPI bus
+	unsigned long delayCalls; //!< delayMicroseconds() calls
+	unsigned long delayUs; //!< Time spent in delayMicroseconds() in us
+	unsigned long spiEnds; //!< SPI.end() calls
+	unsigned long conflicts; //!< Bytes clocked while more devices were selected
+	unsigned long disabledTransfers; //!< Bytes clocked while SPI was disabled by SPI.end()
+} simCounters_t;
+
+/**
+ * Virtual time and SPI bus of the host build
+ * Time advances by delays, by clocked SPI bytes (IQSPI_CLOCK) and by 1 us on every clock read,
+ * which stands for CPU time of the MCU
+ */
+class Simulation {
+public:
+	static void attach(SimDevice *device);
+	static void detachAll();
+	static unsigned long now();
+	static void advance(unsigned long us);
+	static void resetCounters();
+	static simCounters_t& getCounters();
+	static uint8_t getPinLevel(uint8_t pin);
+	static bool isSpiEnabled();
+};
+
+#endif
@@ -0,0 +1,397 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Serial bridge between a host on pseudo terminal and simulated TR module
+ * Serial line of the MCU is the master side of a pty, it accepts bytes at BAUD_RATE of virtual time
+ * through a Tx buffer of UART_BUFFER bytes, the host reads and writes the slave side
+ * 1) Host sends data frames with all its credits, TR module echoes them, throughput is reported
+ * 2) Host stops reading while TR module sends data, the pty fills up and rejects writes,
+ *    after the host reads again every frame must arrive complete
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "IQRF.h"
+#include "SimTR.h"
+
+/// Baud rate of serial line
+#define BAUD_RATE 115200UL
+/// Transfer time of one byte with start and stop bit in us
+#define BYTE_US (10 * MICRO_SECOND / BAUD_RATE)
+/// Size of Tx buffer of serial line
+#define UART_BUFFER 64
+/// Data length of frames from host
+#define FRAME_DATA 32
+/// Duration of throughput measurement in us
+#define MEASURE_US (2 * MICRO_SECOND)
+/// Duration of stalled host in us
+#define STALL_US (10 * MICRO_SECOND)
+/// Maximal duration of draining after the stall in us
+#define DRAIN_US (30 * MICRO_SECOND)
+
+/**
+ * Serial line of the MCU on master side of pty
+ */
+class PtyStream : public Stream {
+public:
+	/**
+	 * Open pty
+	 * @return Slave side of pty or -1
+	 */
+	int begin() {
+		this->fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if (this->fd < 0 || grantpt(this->fd) || unlockpt(this->fd)) {
+			return -1;
+		}
+		int slave = open(ptsname(this->fd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (slave < 0) {
+			return -1;
+		}
+		// frames are binary, line discipline must not change them
+		struct termios settings;
+		tcgetattr(slave, &settings);
+		cfmakeraw(&settings);
+		tcsetattr(slave, TCSANOW, &settings);
+		fcntl(this->fd, F_SETFL, fcntl(this->fd, F_GETFL) | O_NONBLOCK);
+		this->pending = -1;
+		this->queued = 0;
+		this->lastUs = Simulation::now();
+		this->byteCount = 0;
+		this->rejectedWrites = 0;
+		return slave;
+	}
+	size_t write(uint8_t value) {
+		return this->write(&value, 1);
+	}
+	/**
+	 * Write bytes to pty, the count may be lower if the pty is full
+	 */
+	size_t write(const uint8_t *buffer, size_t size) {
+		this->update();
+		ssize_t written = ::write(this->fd, buffer, size);
+		if (written < 0) {
+			written = 0;
+		}
+		if ((size_t) written < size) {
+			this->rejectedWrites++;
+		}
+		this->queued += written;
+		this->byteCount += written;
+		return written;
+	}
+	/**
+	 * Get free space of Tx buffer, it is emptied at baud rate of virtual time
+	 */
+	int availableForWrite() {
+		this->update();
+		return UART_BUFFER - this->queued;
+	}
+	int available() {
+		if (this->pending < 0) {
+			uint8_t value;
+			if (::read(this->fd, &value, 1) == 1) {
+				this->pending = value;
+			}
+		}
+		return this->pending >= 0;
+	}
+	int read() {
+		int value = this->available() ? this->pending : -1;
+		this->pending = -1;
+		return value;
+	}
+	int peek() {
+		return this->available() ? this->pending : -1;
+	}
+	/// Bytes written to pty
+	unsigned long byteCount;
+	/// Writes which were not accepted whole by pty
+	unsigned long rejectedWrites;
+private:
+	/**
+	 * Remove transmitted bytes from Tx buffer
+	 */
+	void update() {
+		unsigned long bytes = (Simulation::now() - this->lastUs) / BYTE_US;
+		this->queued = (bytes >= this->queued) ? 0 : this->queued - bytes;
+		this->lastUs += bytes * BYTE_US;
+	}
+	/// Master side of pty
+	int fd;
+	/// Byte read from pty and not passed yet or -1
+	int pending;
+	/// Bytes in Tx buffer
+	unsigned long queued;
+	/// Time of last update of Tx buffer in us
+	unsigned long lastUs;
+};
+
+/**
+ * Host on slave side of pty
+ */
+class Host {
+public:
+	void begin(int fd) {
+		memset(this, 0, sizeof(*this));
+		this->fd = fd;
+	}
+	/**
+	 * Send data frame if the host has a credit
+	 * @return Frame was sent
+	 */
+	bool send() {
+		if (this->credits == 0) {
+			return false;
+		}
+		uint8_t frame[2 * (FRAME_DATA + 3) + 2];
+		uint8_t length = 0;
+		uint8_t sequence = ++this->sequence ? this->sequence : ++this->sequence;
+		uint8_t crc = 0x5F ^ IQRFBridge::frameTypes::DATA ^ sequence;
+		frame[length++] = IQRFBridge::framingBytes::FLAG;
+		length = this->put(frame, length, IQRFBridge::frameTypes::DATA);
+		length = this->put(frame, length, sequence);
+		for (uint8_t i = 0; i < FRAME_DATA; i++) {
+			uint8_t value = sequence + i;
+			crc ^= value;
+			length = this->put(frame, length, value);
+		}
+		length = this->put(frame, length, crc);
+		frame[length++] = IQRFBridge::framingBytes::FLAG;
+		if (::write(this->fd, frame, length) != length) {
+			return false;
+		}
+		this->credits--;
+		this->sentFrames++;
+		return true;
+	}
+	/**
+	 * Read and decode all bytes available on pty
+	 */
+	void poll() {
+		uint8_t buffer[256];
+		ssize_t length;
+		while ((length = ::read(this->fd, buffer, sizeof(buffer))) > 0) {
+			for (ssize_t i = 0; i < length; i++) {
+				this->decode(buffer[i]);
+			}
+		}
+	}
+	/// Credits for data frames
+	uint8_t credits;
+	/// Data frames sent to the bridge
+	unsigned long sentFrames;
+	/// Result frames with OK result
+	unsigned long okResults;
+	/// Result frames with other result
+	unsigned long failedResults;
+	/// Data frames from TR module
+	unsigned long moduleFrames;
+	/// Frames with wrong CRC, length or content
+	unsigned long errorFrames;
+private:
+	uint8_t put(uint8_t *frame, uint8_t length, uint8_t value) {
+		if (value == IQRFBridge::framingBytes::FLAG || value == IQRFBridge::framingBytes::ESCAPE) {
+			frame[length++] = IQRFBridge::framingBytes::ESCAPE;
+			value ^= IQRFBridge::framingBytes::ESCAPE_XOR;
+		}
+		frame[length++] = value;
+		return length;
+	}
+	void decode(uint8_t value) {
+		if (value == IQRFBridge::framingBytes::FLAG) {
+			if (this->length) {
+				this->frame();
+			}
+			this->length = 0;
+			this->escape = false;
+			return;
+		}
+		if (value == IQRFBridge::framingBytes::ESCAPE) {
+			this->escape = true;
+			return;
+		}
+		if (this->escape) {
+			value ^= IQRFBridge::framingBytes::ESCAPE_XOR;
+			this->escape = false;
+		}
+		if (this->length < sizeof(this->buffer)) {
+			this->buffer[this->length] = value;
+		}
+		this->length++;
+	}
+	void frame() {
+		uint8_t crc = 0;
+		for (uint16_t i = 0; i < this->length && i < sizeof(this->buffer); i++) {
+			crc ^= this->buffer[i];
+		}
+		if (this->length < 4 || this->length > sizeof(this->buffer) || crc != 0x5F) {
+			this->errorFrames++;
+			return;
+		}
+		uint8_t dataLength = this->length - 3;
+		switch (this->buffer[0]) {
+			case IQRFBridge::frameTypes::READY:
+				this->credits = this->buffer[2];
+				break;
+			case IQRFBridge::frameTypes::RESULT:
+				this->credits++;
+				if (this->buffer[2] == IQRFPackets::statuses::OK) {
+					this->okResults++;
+				} else {
+					this->failedResults++;
+				}
+				break;
+			case IQRFBridge::frameTypes::DATA:
+				// echoed and injected data count up from the first byte
+				for (uint8_t i = 1; i < dataLength; i++) {
+					if (this->buffer[2 + i] != (uint8_t) (this->buffer[2] + i)) {
+						this->errorFrames++;
+						return;
+					}
+				}
+				this->moduleFrames++;
+				break;
+			default:
+				this->errorFrames++;
+				break;
+		}
+	}
+	/// Slave side of pty
+	int fd;
+	/// Sequence number of last data frame
+	uint8_t sequence;
+	/// Received frame
+	uint8_t buffer[PACKET_SIZE];
+	/// Length of received frame
+	uint16_t length;
+	/// Next byte is escaped
+	bool escape;
+};
+
+/// Simulated TR module
+SimTR simTr(10, 6);
+/// Driver
+IQRF iqrf;
+/// Bridge
+IQRFBridge bridge;
+/// Serial line of the MCU
+PtyStream serial;
+/// Host
+Host host;
+/// Some check failed
+bool failed = false;
+
+void rxHandler(const uint8_t *data, uint8_t dataLength) {
+	bridge.rxDone(data, dataLength);
+}
+
+void txHandler(uint8_t packetId, uint8_t packetResult) {
+	bridge.txDone(packetId, packetResult);
+}
+
+/**
+ * Run the MCU and the host
+ * @param us Duration in virtual us
+ * @param hostReads Host reads pty
+ * @param hostSends Host sends data frames
+ * @param inject TR module sends data
+ */
+void run(unsigned long us, bool hostReads, bool hostSends, bool inject) {
+	unsigned long startUs = Simulation::now();
+	uint8_t data[FRAME_DATA];
+	uint8_t first = 0;
+	while (Simulation::now() - startUs < us) {
+		if (hostReads) {
+			host.poll();
+		}
+		if (hostSends) {
+			while (host.send());
+		}
+		if (inject) {
+			for (uint8_t i = 0; i < sizeof(data); i++) {
+				data[i] = first + i;
+			}
+			if (simTr.inject(data, sizeof(data))) {
+				first++;
+			}
+		}
+		iqrf.driver();
+		bridge.task();
+		Simulation::advance(random(1, 20));
+	}
+}
+
+/**
+ * Print and check value
+ * @param name Name of value
+ * @param value Value
+ * @param ok Value is expected
+ */
+void report(const char *name, unsigned long value, bool ok = true) {
+	printf("  %-40s %lu\n", name, value);
+	failed |= !ok;
+}
+
+int main() {
+	int slave = serial.begin();
+	if (slave < 0) {
+		printf("pty can not be opened: %s\n", strerror(errno));
+		return 1;
+	}
+	Simulation::attach(&simTr);
+	simTr.enableEcho();
+	simTr.setProcessTime(2000);
+	iqrf.setPins(10, 6);
+	iqrf.disableLog();
+	iqrf.begin(rxHandler, txHandler);
+	iqrf.enableBurstMode();
+	host.begin(slave);
+	bridge.begin(&iqrf, &serial);
+
+	printf("Host sends data frames of %d B over pty at %lu Bd for %lu ms, TR module echoes them\n", FRAME_DATA, BAUD_RATE, (unsigned long) (MEASURE_US / MILLI_SECOND));
+	run(MEASURE_US, true, true, false);
+	report("data frames from host per second", host.okResults * MICRO_SECOND / MEASURE_US, host.okResults > 0);
+	report("data frames from TR module per second", host.moduleFrames * MICRO_SECOND / MEASURE_US, host.moduleFrames > 0);
+	report("bytes written to pty per second", serial.byteCount * MICRO_SECOND / MEASURE_US);
+	report("serial line utilization %", serial.byteCount * BYTE_US * 100 / MEASURE_US);
+	report("ring buffer high water mark", bridge.getRingHighWaterMark());
+
+	printf("Host does not read pty for %lu ms while TR module sends data, then it reads again\n", (unsigned long) (STALL_US / MILLI_SECOND));
+	run(STALL_US, false, false, true);
+	report("writes rejected by full pty", serial.rejectedWrites, serial.rejectedWrites > 0);
+	unsigned long startUs = Simulation::now();
+	while ((host.moduleFrames + host.errorFrames < bridge.getModuleFrameCount() || host.credits < BRIDGE_CREDITS) &&
+		Simulation::now() - startUs < DRAIN_US) {
+		run(10000, true, false, false);
+	}
+	report("data frames from TR module passed by bridge", bridge.getModuleFrameCount());
+	report("data frames from TR module at host", host.moduleFrames, host.moduleFrames == bridge.getModuleFrameCount());
+	report("frames with wrong CRC or content at host", host.errorFrames, host.errorFrames == 0);
+	report("frames dropped by bridge", bridge.getDroppedFrameCount());
+	report("results of data frames from host", host.okResults + host.failedResults, host.okResults + host.failedResults == host.sentFrames && host.failedResults == 0);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Three TR modules on one SPI bus driven by IQRFBus
+ * 1) Modules 0 and 2 send packets while module 1 starts and enters programming mode to read its info
+ *    and while module 1 enters programming mode from its Tx callback, inside of the bus round.
+ *    SPI must not be disabled for modules 0 and 2 and no two SS pins may be active at once
+ * 2) All modules send packets of 64 B for 2 s, per module throughput and fairness are reported
+ */
+
+#include <stdio.h>
+
+#include "IQRF.h"
+#include "IQRFBus.h"
+#include "SimTR.h"
+
+/// Count of TR modules
+#define MODULES 3
+/// Duration of throughput measurement in us
+#define MEASURE_US (2 * MICRO_SECOND)
+/// Time of processing of written packet in TR module in us
+#define PROCESS_US 2000
+/// Count of programming mode entries from Tx callback
+#define PGM_ENTRIES 10
+
+/// Simulated TR modules
+SimTR simTr[MODULES] = {SimTR(10, 6), SimTR(9, 5), SimTR(8, 4)};
+/// Drivers
+IQRF iqrf[MODULES];
+/// Scheduler
+IQRFBus bus;
+/// Count of successfully written packets of each module
+unsigned long txOk[MODULES];
+/// Count of failed packets of each module
+unsigned long txFailed[MODULES];
+/// Module 1 enters programming mode in its next Tx callback
+bool pgmRequest = false;
+/// Some check failed
+bool failed = false;
+
+void rxHandler() {
+}
+
+void txDone(uint8_t module, uint8_t packetResult) {
+	if (packetResult == IQRFPackets::statuses::OK) {
+		txOk[module]++;
+	} else {
+		txFailed[module]++;
+	}
+}
+
+void txHandler0(uint8_t packetId, uint8_t packetResult) {
+	txDone(0, packetResult);
+}
+
+void txHandler1(uint8_t packetId, uint8_t packetResult) {
+	txDone(1, packetResult);
+	if (pgmRequest) {
+		pgmRequest = false;
+		iqrf[1].getTr().enterProgramMode();
+	}
+}
+
+void txHandler2(uint8_t packetId, uint8_t packetResult) {
+	txDone(2, packetResult);
+}
+
+/**
+ * Fill Tx queues of ready modules and drive the bus
+ * @param us Duration in virtual us
+ * @param senders Bit mask of modules which send packets
+ */
+void run(unsigned long us, uint8_t senders) {
+	uint8_t data[64];
+	for (uint8_t i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+	unsigned long startUs = Simulation::now();
+	while (Simulation::now() - startUs < us) {
+		for (uint8_t i = 0; i < MODULES; i++) {
+			if ((senders & (1 << i)) && iqrf[i].isReady() && iqrf[i].canSendData(sizeof(data))) {
+				iqrf[i].sendData(data, sizeof(data));
+			}
+		}
+		bus.driver();
+		// loop time varies, so packets of the modules do not keep fixed phase in the bus round
+		Simulation::advance(random(1, 20));
+	}
+}
+
+/**
+ * Check counter of simulated bus
+ * @param name Name of counter
+ * @param value Value of counter
+ */
+void expectZero(const char *name, unsigned long value) {
+	printf("  %-36s %lu\n", name, value);
+	failed |= value != 0;
+}
+
+int main() {
+	uint8_t ssPins[MODULES] = {10, 9, 8};
+	uint8_t resetPins[MODULES] = {6, 5, 4};
+	bus.begin();
+	for (uint8_t i = 0; i < MODULES; i++) {
+		Simulation::attach(&simTr[i]);
+		simTr[i].setProcessTime(PROCESS_US);
+		iqrf[i].setPins(ssPins[i], resetPins[i]);
+		iqrf[i].disableLog();
+		iqrf[i].enableBurstMode();
+		bus.add(&iqrf[i]);
+	}
+	iqrf[0].begin(rxHandler, txHandler0);
+	iqrf[2].begin(rxHandler, txHandler2);
+	printf("Module 1 starts while modules 0 and 2 send packets\n");
+	Simulation::resetCounters();
+	run(100000UL, 0x05);
+	iqrf[1].beginAsync(rxHandler, txHandler1);
+	while (!iqrf[1].isReady()) {
+		run(1000, 0x05);
+	}
+	run(100000UL, 0x05);
+	printf("Module 1 enters programming mode %d times from its Tx callback\n", PGM_ENTRIES);
+	for (uint8_t i = 0; i < PGM_ENTRIES; i++) {
+		uint8_t data = i;
+		pgmRequest = true;
+		iqrf[1].sendData(&data, 1);
+		while (pgmRequest || iqrf[1].getTr().getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_PENDING ||
+			iqrf[1].getTr().getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_VERIFY) {
+			run(1000, 0x05);
+		}
+		iqrf[1].endProgramMode();
+		run(50000UL, 0x05);
+	}
+	simCounters_t &counters = Simulation::getCounters();
+	expectZero("bytes clocked with SPI disabled", counters.disabledTransfers);
+	expectZero("bytes clocked with more SS active", counters.conflicts);
+	printf("  %-36s %lu\n", "programming mode entries of module 1", simTr[1].getProgramEntryCount());
+	printf("  %-36s %d\n", "module type of module 1", iqrf[1].getTr().getModuleType());
+	failed |= simTr[1].getProgramEntryCount() != 1 + PGM_ENTRIES || simTr[1].getMode() != IQRFSPI::statuses::COMMUNICATION_MODE;
+	failed |= iqrf[1].getTr().getModuleType() != IQRFTR::types::TR_72D;
+
+	printf("All modules send packets of 64 B for %lu ms, TR module processes a packet for %d us\n", (unsigned long) (MEASURE_US / MILLI_SECOND), PROCESS_US);
+	Simulation::resetCounters();
+	bus.resetCounters();
+	for (uint8_t i = 0; i < MODULES; i++) {
+		txOk[i] = 0;
+		txFailed[i] = 0;
+	}
+	run(MEASURE_US, 0x07);
+	printf("  module  packets  packets/s  failed  driver calls  bus time us  max wait us\n");
+	for (uint8_t i = 0; i < MODULES; i++) {
+		printf("  %6d  %7lu  %9.1f  %6lu  %12lu  %11lu  %11lu\n", i, txOk[i], txOk[i] * (double) MICRO_SECOND / MEASURE_US,
+			txFailed[i], bus.getGrantCount(i), bus.getBusTime(i), bus.getMaxWaitTime(i));
+		failed |= txOk[i] == 0 || txFailed[i] != 0 || simTr[i].getCrcmErrorCount() != 0;
+	}
+	printf("  fairness index of bus time %.3f\n", bus.getFairness());
+	failed |= bus.getFairness() < 0.95;
+	expectZero("bytes clocked with SPI disabled", counters.disabledTransfers);
+	expectZero("bytes clocked with more SS active", counters.conflicts);
+	return failed ? 1 : 0;
+}
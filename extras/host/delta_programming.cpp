@@ -0,0 +1,169 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * EEPROM image is programmed to simulated TR module in delta mode
+ * 1) TR module returns EEPROM content in programming mode: the first block is written and verified,
+ *    programming of the same image again skips all other blocks
+ * 2) TR module echoes request in programming mode: read back fails and all blocks are written
+ */
+
+#include <stdio.h>
+
+#include "IQRF.h"
+#include "IQRFProgrammer.h"
+#include "SimTR.h"
+
+/// Count of EEPROM blocks in the image
+#define BLOCKS 4
+/// Maximal duration of programming in us
+#define PROGRAM_US (10 * MICRO_SECOND)
+
+/**
+ * Stream of the image in memory
+ */
+class ImageStream : public Stream {
+public:
+	void begin(const char *text) {
+		this->text = text;
+	}
+	size_t write(uint8_t value) {
+		return 0;
+	}
+	int available() {
+		return strlen(this->text);
+	}
+	int read() {
+		return *this->text ? *this->text++ : -1;
+	}
+	int peek() {
+		return *this->text ? *this->text : -1;
+	}
+private:
+	/// Rest of the image
+	const char *text;
+};
+
+/// Simulated TR module
+SimTR simTr(10, 6);
+/// Driver
+IQRF iqrf;
+/// Programmer
+IQRFProgrammer programmer;
+/// Intel HEX image
+char image[4096];
+/// Stream of the image
+ImageStream stream;
+/// Some check failed
+bool failed = false;
+
+void rxHandler() {
+}
+
+void txHandler(uint8_t packetId, uint8_t packetResult) {
+	programmer.txDone(packetId, packetResult);
+}
+
+/**
+ * Append Intel HEX record to the image
+ * @param type Record type
+ * @param address Record address
+ * @param data Record data
+ * @param length Data length
+ */
+void appendRecord(uint8_t type, uint16_t address, const uint8_t *data, uint8_t length) {
+	char *end = image + strlen(image);
+	uint8_t checksum = length + (address >> 8) + (address & 0xFF) + type;
+	end += sprintf(end, ":%02X%04X%02X", length, address, type);
+	for (uint8_t i = 0; i < length; i++) {
+		end += sprintf(end, "%02X", data[i]);
+		checksum += data[i];
+	}
+	sprintf(end, "%02X\n", (uint8_t) -checksum);
+}
+
+/**
+ * Build image of BLOCKS EEPROM blocks, EEPROM bytes are low bytes of words
+ */
+void buildImage() {
+	uint8_t data[PGM_RECORD_SIZE];
+	uint8_t base[2] = {(uint8_t) (PGM_EEPROM_ADDRESS >> 24), (uint8_t) (PGM_EEPROM_ADDRESS >> 16)};
+	image[0] = 0;
+	appendRecord(0x04, 0, base, sizeof(base));
+	for (uint16_t offset = 0; offset < BLOCKS * PGM_BLOCK_SIZE * 2; offset += sizeof(data)) {
+		for (uint8_t i = 0; i < sizeof(data); i++) {
+			data[i] = (i & 1) ? 0 : (uint8_t) (offset / 2 + i / 2 + 0x40);
+		}
+		appendRecord(0x00, (PGM_EEPROM_ADDRESS & 0xFFFF) + offset, data, sizeof(data));
+	}
+	appendRecord(0x01, 0, NULL, 0);
+}
+
+/**
+ * Program the image in delta mode
+ * @param expectedStatus Expected read back status
+ * @param expectedWrites Expected count of EEPROM_PGM packets
+ * @param expectedSkipped Expected count of skipped blocks
+ */
+void program(uint8_t expectedStatus, unsigned long expectedWrites, unsigned long expectedSkipped) {
+	unsigned long writes = simTr.getEepromWriteCount();
+	stream.begin(image);
+	programmer.enableDeltaMode();
+	if (!programmer.begin(&iqrf, &stream, IQRFProgrammer::formats::HEX_FORMAT)) {
+		printf("  programming was not started\n");
+		failed = true;
+		return;
+	}
+	unsigned long startUs = Simulation::now();
+	while (programmer.task() && Simulation::now() - startUs < PROGRAM_US) {
+		iqrf.driver();
+	}
+	writes = simTr.getEepromWriteCount() - writes;
+	bool content = true;
+	for (uint16_t i = 0; i < BLOCKS * PGM_BLOCK_SIZE; i++) {
+		content &= simTr.eeprom[i] == (uint8_t) (i + 0x40);
+	}
+	printf("  %-36s %d\n", "programmer status", programmer.getStatus());
+	printf("  %-36s %d\n", "read back status", programmer.getReadBackStatus());
+	printf("  %-36s %lu\n", "written EEPROM blocks", writes);
+	printf("  %-36s %lu\n", "skipped EEPROM blocks", programmer.getSkippedBlockCount());
+	printf("  %-36s %s\n", "EEPROM content", content ? "OK" : "wrong");
+	failed |= programmer.getStatus() != IQRFProgrammer::statuses::DONE || programmer.getReadBackStatus() != expectedStatus;
+	failed |= writes != expectedWrites || programmer.getSkippedBlockCount() != expectedSkipped || !content;
+}
+
+int main() {
+	Simulation::attach(&simTr);
+	simTr.setProcessTime(2000);
+	iqrf.setPins(10, 6);
+	iqrf.disableLog();
+	iqrf.begin(rxHandler, txHandler);
+	buildImage();
+
+	printf("TR module returns EEPROM content in programming mode, image of %d blocks is programmed twice\n", BLOCKS);
+	program(IQRFProgrammer::readBackStatuses::READ_BACK_VERIFIED, BLOCKS, 0);
+	program(IQRFProgrammer::readBackStatuses::READ_BACK_VERIFIED, 1, BLOCKS - 1);
+
+	printf("TR module echoes read requests in programming mode, image is programmed again\n");
+	simTr.setReadInProgramMode(false);
+	program(IQRFProgrammer::readBackStatuses::READ_BACK_FAILED, BLOCKS, 0);
+	return failed ? 1 : 0;
+}
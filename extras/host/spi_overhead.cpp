@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Per packet SPI overhead of byte transfers and of block transfer
+ * 1) 68 B WR_RD write to simulated TR module by 68 IQSPI::transfer() calls with byte to byte pause
+ *    (burst mode before transferBlock()) and by one IQSPI::transferBlock(), with fast SPI pause
+ *    and without pause, which shows fixed cost of SS assertion and SPI transaction alone
+ * 2) Tx packets of 64 B sent by the driver in per byte mode and in burst mode
+ */
+
+#include <stdio.h>
+
+#include "IQRF.h"
+#include "SimTR.h"
+
+/// Count of Tx packets sent by the driver in each mode
+#define DRIVER_PACKETS 100
+/// Byte to byte pause of fast SPI in us
+#define FAST_BYTE_PAUSE 150
+
+/// Simulated TR module
+SimTR simTr(TR_SS_PIN, TR_RESET_PIN);
+/// Driver
+IQRF iqrf;
+/// Count of finished Tx packets
+unsigned long txCount = 0;
+/// Some packet was not transferred correctly
+bool failed = false;
+
+void rxHandler() {
+}
+
+void txHandler(uint8_t packetId, uint8_t packetResult) {
+	txCount++;
+}
+
+/**
+ * Build 68 B WR_RD write packet
+ * @param packet Packet
+ */
+void buildPacket(uint8_t *packet) {
+	uint8_t crcm = 0x5F ^ IQRFSPI::commands::WR_RD ^ (64 | 0x80);
+	packet[0] = IQRFSPI::commands::WR_RD;
+	packet[1] = 64 | 0x80;
+	for (uint8_t i = 0; i < 64; i++) {
+		packet[i + 2] = i;
+		crcm ^= i;
+	}
+	packet[66] = crcm;
+	packet[67] = 0;
+}
+
+/**
+ * Print counters of SPI bus
+ * @param name Name of measured case
+ * @param count Count of packets
+ * @param us Duration in virtual us
+ */
+void printCounters(const char *name, unsigned long count, unsigned long us) {
+	simCounters_t &counters = Simulation::getCounters();
+	printf("  %-9s %7.1f SS edges %6.1f transactions %6.1f delay calls %8.1f us of delays %8.1f us per packet\n",
+		name, (double) counters.ssEdges / count, (double) counters.transactions / count,
+		(double) counters.delayCalls / count, (double) counters.delayUs / count, (double) us / count);
+}
+
+/**
+ * Transfer 68 B packet by IQSPI methods
+ * @param bytePause Byte to byte pause in us
+ */
+void measureIqSpi(unsigned long bytePause) {
+	IQSPI iqSpi;
+	uint8_t tx[PACKET_SIZE];
+	uint8_t rx[PACKET_SIZE];
+	buildPacket(tx);
+	iqSpi.begin();
+	printf("68 B packet by IQSPI, byte to byte pause %lu us\n", bytePause);
+	// burst mode before transferBlock(), every byte by IQSPI::transfer()
+	Simulation::advance(MICRO_SECOND);
+	Simulation::resetCounters();
+	unsigned long startUs = Simulation::now();
+	unsigned long byteStartUs = 0;
+	for (uint8_t i = 0; i < PACKET_SIZE; i++) {
+		if (i) {
+			unsigned long elapsedUs = micros() - byteStartUs;
+			if (elapsedUs < bytePause) {
+				delayMicroseconds(bytePause - elapsedUs);
+			}
+		}
+		byteStartUs = micros();
+		rx[i] = iqSpi.transfer(tx[i]);
+	}
+	printCounters("per byte", 1, Simulation::now() - startUs);
+	bool perByteOk = rx[PACKET_SIZE - 1] == IQRFSPI::statuses::CRCM_OK;
+	Simulation::advance(MICRO_SECOND);
+	Simulation::resetCounters();
+	startUs = Simulation::now();
+	iqSpi.transferBlock(tx, rx, PACKET_SIZE, bytePause);
+	printCounters("block", 1, Simulation::now() - startUs);
+	bool blockOk = rx[PACKET_SIZE - 1] == IQRFSPI::statuses::CRCM_OK;
+	printf("  accepted by TR module: per byte %s, block %s\n", perByteOk ? "yes" : "no", blockOk ? "yes" : "no");
+	failed |= !perByteOk || !blockOk;
+}
+
+/**
+ * Send Tx packets by the driver
+ * @param burst Burst mode is enabled
+ */
+void measureDriver(bool burst) {
+	uint8_t data[64];
+	for (uint8_t i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+	if (burst) {
+		iqrf.enableBurstMode();
+	} else {
+		iqrf.disableBurstMode();
+	}
+	unsigned long written = simTr.getWrittenCount();
+	txCount = 0;
+	Simulation::resetCounters();
+	unsigned long startUs = Simulation::now();
+	for (unsigned long sent = 0; sent < DRIVER_PACKETS || txCount < DRIVER_PACKETS; ) {
+		if (sent < DRIVER_PACKETS && iqrf.canSendData(sizeof(data)) && iqrf.sendData(data, sizeof(data))) {
+			sent++;
+		}
+		iqrf.driver();
+		Simulation::advance(10);
+	}
+	printCounters(burst ? "burst" : "per byte", DRIVER_PACKETS, Simulation::now() - startUs);
+	written = simTr.getWrittenCount() - written;
+	printf("            %lu packets written to TR module, %lu CRCM errors\n", written, simTr.getCrcmErrorCount());
+	failed |= written != DRIVER_PACKETS || simTr.getCrcmErrorCount() != 0;
+}
+
+int main() {
+	Simulation::attach(&simTr);
+	measureIqSpi(FAST_BYTE_PAUSE);
+	measureIqSpi(0);
+	iqrf.disableLog();
+	iqrf.begin(rxHandler, txHandler);
+	printf("Driver, %d Tx packets of 64 B, TR module type %d\n", DRIVER_PACKETS, iqrf.getTr().getModuleType());
+	measureDriver(false);
+	measureDriver(true);
+	return failed ? 1 : 0;
+}
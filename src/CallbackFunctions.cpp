@@ -36,19 +36,3 @@ void doNothingRx() {
 void doNothingTx(uint8_t packetId, uint8_t packetResult) {
 	__asm__("nop\n\t");
 }
-
-/**
- * Process identification data packet from TR module
- */
-void identifyRx() {
-	trIdentify();
-}
-
-/**
- * Process identification data packet from TR module
- * @param packetId Packet ID
- * @param packetResult Operation result
- */
-void identifyTx(uint8_t packetId, uint8_t packetResult) {
-	trIdentify();
-}
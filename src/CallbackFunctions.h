@@ -24,11 +24,7 @@
 
 #include <stdint.h>
 
-#include "iqrf_library.h"
-
 void doNothingRx();
 void doNothingTx(uint8_t packetId, uint8_t packetResult);
-void identifyRx();
-void identifyTx(uint8_t packetId, uint8_t packetResult);
 
 #endif
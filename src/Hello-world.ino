@@ -55,7 +55,6 @@ void msTimerCallback();
  */
 typedef struct {
 	uint8_t rxBuffer[PACKET_SIZE]; //!< Rx buffer
-	uint8_t *txBuffer; //!< Tx buffer
 	uint8_t packetId; //!< Packet ID
 	volatile uint16_t timer; //!< Timer
 	volatile bool timerAck; //!< Timer action
@@ -64,7 +63,7 @@ appVarsStruct appVars;
 
 /// Instances
 IQRF iqrf;
-IQRFTR iqrfTr;
+IQRFTR &iqrfTr = iqrf.getTr();
 
 // Const data
 const char testBuffer[12] = {'H', 'e', 'l', 'l', 'o', ' ', 'W', 'o', 'r', 'l', 'd', '!'};
@@ -115,14 +114,8 @@ void loop() {
 	iqrf.driver();
 	// Test send data every 5s
 	if (appVars.timerAck) {
-		// Allocate memory for Tx packet
-		appVars.txBuffer = (uint8_t *) malloc(sizeof(testBuffer));
-		if (appVars.txBuffer != NULL) {
-			// Copy data from test to Tx packet
-			memcpy(appVars.txBuffer, (uint8_t *) & testBuffer, sizeof(testBuffer));
-			// Send data and unallocate data buffer
-			appVars.packetId = iqrf.sendData(appVars.txBuffer, sizeof(testBuffer), 1);
-		}
+		// Send data, they are copied to Tx queue
+		appVars.packetId = iqrf.sendData((const uint8_t *) testBuffer, sizeof(testBuffer));
 		appVars.timerAck = false;
 	}
 }
@@ -22,45 +22,13 @@
 #ifndef IQRF_H
 #define IQRF_H
 
-#include <stdint.h>
-
-#include "IQRFCallbacks.h"
-#include "IQRFSPI.h"
+#include "IQRFDriver.h"
 #include "iqrf_library.h"
 
 /**
- * IQRF
+ * IQRF driver with buffers sized by IQRFSettings.h
  */
-class IQRF {
-public:
-	void begin(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback);
-	void driver();
-	uint8_t getDataLength();
-	void getData(uint8_t *dataBuffer, uint8_t dataLength);
-	uint8_t sendData(uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag);
-	void setPTYPE(uint8_t PTYPE);
-	uint8_t getPTYPE();
-	void setAttepmtsCount(uint8_t attepmts);
-	uint8_t getAttepmtsCount();
-	void setByteCount(uint8_t count);
-	uint8_t getByteCount();
-	void setUsCount0(unsigned long us);
-	unsigned long getUsCount0();
-	void setUsCount1(unsigned long us);
-	unsigned long getUsCount1();
-private:
-	/// PTYPE
-	uint8_t PTYPE;
-	/// Count of attempts to send data
-	uint8_t attepmtsCounter;
-	/// Count number of send/receive bytes
-	uint8_t byteCounter;
-	/// Microsecond counter 0
-	unsigned long usCounter0;
-	/// Microsecond counter 1
-	unsigned long usCounter1;
-	/// Instance of IQRFSPI class
-	IQRFSPI spi;
+class IQRF : public IQRFDriver<PACKET_BUFFER_SIZE, PACKET_ARENA_SIZE, RX_FRAME_COUNT, PACKET_BUFFER_HIGH_SIZE, PACKET_ARENA_HIGH_SIZE> {
 };
 
 #endif
@@ -0,0 +1,546 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFBase.h"
+
+/**
+ * Set pins of TR module, more TR modules can share SPI bus with different SS pins
+ * Function must be called before begin(), SS pin is set to inactive state immediately
+ * so that the TR module does not listen to SPI traffic of other TR modules
+ * @param ssPin SPI SS pin
+ * @param resetPin TR reset pin
+ */
+void IQRFBase::setPins(uint8_t ssPin, uint8_t resetPin) {
+	this->iqSpi.setSsPin(ssPin);
+	this->tr.setResetPin(resetPin);
+	pinMode(ssPin, OUTPUT);
+	digitalWrite(ssPin, HIGH);
+}
+
+/**
+ * Set bus shared with other TR modules, called by IQRFBus::add()
+ * Blocking calls (begin(), BLOCK overflow policy) then drive whole bus instead of this TR module only
+ * @param bus Bus or NULL
+ */
+void IQRFBase::setBus(IQRFBus *bus) {
+	this->bus = bus;
+	// SPI peripheral is used by other TR modules, reset of this module releases its SS pin only
+	this->iqSpi.setShared(bus != NULL);
+}
+
+/**
+ * Check if TR module is reset or enters programming mode, SPI of the module is not used meanwhile
+ * @return Reset is in progress
+ */
+bool IQRFBase::isResetting() {
+	return this->tr.isResetting();
+}
+
+/**
+ * Get last SPI status of TR module
+ * @return SPI status (see IQRFSPI::statuses)
+ */
+uint8_t IQRFBase::getSpiStatus() {
+	return this->spi.getStatus();
+}
+
+/**
+ * Check if the driver is initialized and TR module info is read
+ * @return Driver is ready, data can be sent
+ */
+bool IQRFBase::isReady() {
+	return this->ready;
+}
+
+/**
+ * Get TR module of this driver
+ * @return TR module, it provides TR module info read in begin()
+ */
+IQRFTR& IQRFBase::getTr() {
+	return this->tr;
+}
+
+/**
+ * Get tracker of Tx packets, it keeps timestamps of last packets and latency histogram
+ * @return Tracker of Tx packets
+ */
+IQRFTracker& IQRFBase::getTracker() {
+	return this->tracker;
+}
+
+/**
+ * Set persistent cache of TR module info, it must be set before driver initialization
+ * Cached info is verified in communication mode, programming mode is entered only if it does not match
+ * @param cache Cache of TR module info or NULL
+ */
+void IQRFBase::setInfoCache(IQRFInfoCache *cache) {
+	this->infoCache = cache;
+}
+
+/**
+ * Get size of Rx data
+ * @return Number of bytes recieved from TR module
+ */
+uint8_t IQRFBase::getDataLength() {
+	return this->dataLength;
+}
+
+/**
+ * Function is usually called inside the callback function, whitch is called when the driver receives data from TR module
+ * @param dataBuffer Pointer to my buffer, to which I want to load data received from the TR module
+ * @param dataLength Number of bytes I want to read
+ */
+void IQRFBase::getData(uint8_t* dataBuffer, uint8_t dataLength) {
+	memcpy(dataBuffer, &this->buffers.getRxBuffer()[2], dataLength);
+}
+
+/**
+ * Release received data passed to Rx view callback
+ * Rx frame is reused for next SPI transfer, when all Rx frames are held the driver stops
+ * communication with TR module until one of them is released
+ * @param data Pointer to received data passed to Rx view callback
+ */
+void IQRFBase::releaseData(const uint8_t* data) {
+	this->buffers.releaseRxFrame(data);
+	// TR module may wait with data for free Rx frame
+	this->polling.pollNow();
+}
+
+/**
+ * Enable Rx queue, received data are queued with timestamp instead of calling Rx callback
+ * Application reads them by receive() at its own pace, if the queue is full (RX_QUEUE_DEPTH,
+ * at most Rx frames - 1) the oldest not received packet is dropped
+ * Rx queue is disabled by begin(), so it must be enabled after it
+ */
+void IQRFBase::enableRxQueue() {
+	this->buffers.enableRxQueue();
+}
+
+/**
+ * Disable Rx queue, received data are passed to Rx callback
+ */
+void IQRFBase::disableRxQueue() {
+	this->buffers.disableRxQueue();
+}
+
+/**
+ * Get count of received packets waiting in Rx queue
+ * @return Count of received packets
+ */
+uint8_t IQRFBase::available() {
+	return this->buffers.getQueuedRxFrames();
+}
+
+/**
+ * Take the oldest received packet from Rx queue
+ * Packet data are valid until they are released by releaseData(packet->data)
+ * @param packet Received packet
+ * @return Packet was received
+ */
+bool IQRFBase::receive(rxPacket_t* packet) {
+	return this->buffers.dequeueRxFrame(packet);
+}
+
+/**
+ * Get count of received packets dropped from full Rx queue
+ * @return Count of dropped packets
+ */
+unsigned long IQRFBase::getRxDropCount() {
+	return this->buffers.getRxDropCount();
+}
+
+/**
+ * Function sends data from buffer to TR module, data are copied to Tx queue
+ * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module
+ * @param dataLength Number of bytes to send
+ * @param unallocationFlag If the pDataBuffer is dynamically allocated using malloc function.
+   If you wish to unallocate buffer after data is copied, set the unallocationFlag to 1, otherwise to 0.
+ * @return Tx packet ID (number 1-255) or 0 if the packet was rejected or the driver is not ready
+ */
+uint8_t IQRFBase::sendData(uint8_t* dataBuffer, uint8_t dataLength, uint8_t unallocationFlag) {
+	if (!this->ready) {
+		return 0;
+	}
+	return this->sendSpiPacket(this->spi.commands::WR_RD, dataBuffer, dataLength, unallocationFlag);
+}
+
+/**
+ * Function sends data from buffer to TR module, data are copied to Tx queue
+ * Buffer can be reused right after the call, no dynamic allocation is needed
+ * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module
+ * @param dataLength Number of bytes to send
+ * @return Tx packet ID (number 1-255) or 0 if the packet was rejected or the driver is not ready
+ */
+uint8_t IQRFBase::sendData(const uint8_t* dataBuffer, uint8_t dataLength) {
+	if (!this->ready) {
+		return 0;
+	}
+	return this->sendSpiPacket(this->spi.commands::WR_RD, dataBuffer, dataLength, 0);
+}
+
+/**
+ * Function sends data from buffer to TR module with given priority, data are copied to Tx queue
+ * High priority packets (e.g. control commands) are sent before normal priority packets
+ * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module
+ * @param dataLength Number of bytes to send
+ * @param priority Packet priority
+ * @param retryPolicy Retry policy of the packet or NULL for retry policy of the driver
+ * @return Tx packet ID (number 1-255) or 0 if the packet was rejected or the driver is not ready
+ */
+uint8_t IQRFBase::sendPriorityData(const uint8_t* dataBuffer, uint8_t dataLength, uint8_t priority, IQRFRetryPolicy *retryPolicy) {
+	if (!this->ready) {
+		return 0;
+	}
+	return this->sendSpiPacket(this->spi.commands::WR_RD, dataBuffer, dataLength, 0, priority, retryPolicy);
+}
+
+/**
+ * Function sends data from buffer to TR module with own retry policy, data are copied to Tx queue
+ * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module
+ * @param dataLength Number of bytes to send
+ * @param retryPolicy Retry policy of the packet, it must exist until the packet is sent
+ * @return Tx packet ID (number 1-255) or 0 if the packet was rejected or the driver is not ready
+ */
+uint8_t IQRFBase::sendData(const uint8_t* dataBuffer, uint8_t dataLength, IQRFRetryPolicy *retryPolicy) {
+	if (!this->ready) {
+		return 0;
+	}
+	return this->sendSpiPacket(this->spi.commands::WR_RD, dataBuffer, dataLength, 0, this->packets.priorities::NORMAL_PRIORITY, retryPolicy);
+}
+
+/**
+ * Set retry policy of Tx packets sent without own retry policy
+ * @param retryPolicy Retry policy or NULL for built-in retry policy
+ */
+void IQRFBase::setRetryPolicy(IQRFRetryPolicy *retryPolicy) {
+	this->retryPolicy = (retryPolicy != NULL) ? retryPolicy : &this->defaultRetryPolicy;
+}
+
+/**
+ * Get retry policy of Tx packets sent without own retry policy, it can be changed in place
+ * @return Retry policy
+ */
+IQRFRetryPolicy& IQRFBase::getRetryPolicy() {
+	return *this->retryPolicy;
+}
+
+/**
+ * Check if data fit into Tx queue
+ * @param dataLength Number of bytes to send
+ * @param priority Packet priority
+ * @return Data fit into Tx queue
+ */
+bool IQRFBase::canSendData(uint8_t dataLength, uint8_t priority) {
+	return this->getTxQueue(priority)->canPush(dataLength);
+}
+
+/**
+ * Set scheduling of Tx packet priorities, it must be called after begin() (default is strict priority)
+ * @param weight 0 for strict priority, otherwise count of high priority packets
+   sent in a row before one waiting normal priority packet is sent
+ */
+void IQRFBase::setTxPriorityWeight(uint8_t weight) {
+	this->txQueueHigh.setWeight(weight);
+}
+
+/**
+ * Set behaviour of sendData() when Tx queue is full, it must be called after begin() (default is REJECT)
+ * The policy is used by both Tx queues
+ * @param policy Overflow policy
+ * Code |   Policy    | Description
+ * ---- | ----------- | ----------------------------------------------------------------
+ *   0  |   REJECT    | New packet is rejected, sendData() returns 0
+ *   1  |    BLOCK    | sendData() runs driver until slot is free or timeout elapses
+ *   2  | DROP_OLDEST | Oldest packet is dropped, Tx callback is called with DROPPED result
+ * @param timeout Timeout of BLOCK policy in ms
+ */
+void IQRFBase::setTxQueuePolicy(uint8_t policy, unsigned long timeout) {
+	this->txQueue.setOverflowPolicy(policy, timeout);
+	this->txQueueHigh.setOverflowPolicy(policy, timeout);
+}
+
+/**
+ * Get Tx queue of packet priority
+ * @param priority Packet priority
+ * @return Tx queue
+ */
+IQRFTxQueue* IQRFBase::getTxQueue(uint8_t priority) {
+	return (priority == IQRFPackets::HIGH_PRIORITY) ? &this->txQueueHigh : &this->txQueue;
+}
+
+/**
+ * Check if Tx queue is full
+ * @param priority Packet priority of the Tx queue, normal priority queue by default
+ * @return Tx queue is full
+ */
+bool IQRFBase::isTxQueueFull(uint8_t priority) {
+	return this->getTxQueue(priority)->isFull();
+}
+
+/**
+ * Get count of free slots in Tx queue
+ * @param priority Packet priority of the Tx queue, normal priority queue by default
+ * @return Count of free slots in Tx queue
+ */
+uint8_t IQRFBase::getTxQueueFreeSlots(uint8_t priority) {
+	return this->getTxQueue(priority)->getFreeSlots();
+}
+
+/**
+ * Get maximal count of packets waiting in Tx queue
+ * @param priority Packet priority of the Tx queue, normal priority queue by default
+ * @return Maximal count of packets in Tx queue
+ */
+uint8_t IQRFBase::getTxQueueHighWaterMark(uint8_t priority) {
+	return this->getTxQueue(priority)->getHighWaterMark();
+}
+
+/**
+ * Get count of packets rejected or dropped due to full Tx queue
+ * @param priority Packet priority of the Tx queue, normal priority queue by default
+ * @return Count of rejected or dropped packets
+ */
+unsigned long IQRFBase::getTxQueueOverflowCount(uint8_t priority) {
+	return this->getTxQueue(priority)->getOverflowCount();
+}
+
+/**
+ * Enable driver messages printed to Serial
+ */
+void IQRFBase::enableLog() {
+	this->logEnabled = true;
+}
+
+/**
+ * Disable driver messages printed to Serial, it must be called before begin() if Serial carries binary data
+ */
+void IQRFBase::disableLog() {
+	this->logEnabled = false;
+}
+
+/**
+ * Enable burst mode, whole SPI packet is transferred in one driver() call
+ * Byte to byte pause is kept inside the burst, driver() blocks for the packet duration
+ */
+void IQRFBase::enableBurstMode() {
+	this->spi.enableBurstMode();
+}
+
+/**
+ * Disable burst mode, one byte of SPI packet is transferred per driver() call
+ */
+void IQRFBase::disableBurstMode() {
+	this->spi.disableBurstMode();
+}
+
+/**
+ * Enable drain mode, SPI status is checked right after each packet and queued Tx packets
+ * and pending Rx packets are transferred one after another while TR module is ready
+ * In burst mode more packets can be transferred in one driver() call
+ * @param holdTime Time of one driver() call in us, after it no next packet is started
+ */
+void IQRFBase::enableDrainMode(unsigned long holdTime) {
+	this->spi.enableDrainMode(holdTime);
+}
+
+/**
+ * Disable drain mode
+ */
+void IQRFBase::disableDrainMode() {
+	this->spi.disableDrainMode();
+}
+
+/**
+ * Get duration of last SPI packet transfer, it can be used to compare burst and per byte mode
+ * @return Duration of last SPI packet transfer in us
+ */
+unsigned long IQRFBase::getFrameTime() {
+	return this->spi.getFrameTime();
+}
+
+/**
+ * Get result of last SPI packet transfer, aborted packets are classified by SPI status of TR module
+ * @return Result of last SPI packet transfer (see IQRFSPI::frameResults)
+ */
+uint8_t IQRFBase::getFrameResult() {
+	return this->spi.getFrameResult();
+}
+
+/**
+ * Get count of SPI packets aborted after the first byte, TR module was not able to accept them
+ * @return Count of aborted packets
+ */
+unsigned long IQRFBase::getAbortedFrameCount() {
+	return this->statistics.getAbortedFrames();
+}
+
+/**
+ * Set SPI status polling intervals
+ * Status is polled every minUs after traffic, the interval is doubled on each idle poll up to maxUs
+ * @param minUs Minimal status polling interval in us
+ * @param maxUs Maximal status polling interval in us
+ */
+void IQRFBase::setPollIntervals(unsigned long minUs, unsigned long maxUs) {
+	this->polling.setIntervals(minUs, maxUs);
+}
+
+/**
+ * Signal data ready in TR module, status is polled immediately in next driver() call
+ * Function can be called from external interrupt handler (e.g. attachInterrupt)
+ */
+void IQRFBase::dataReady() {
+	this->polling.dataReady();
+}
+
+/**
+ * Get count of SPI status polls
+ * @return Count of SPI status polls
+ */
+unsigned long IQRFBase::getPollCount() {
+	return this->polling.getPollCount();
+}
+
+/**
+ * Get average latency between data ready in TR module and its notice by the driver
+ * Without dataReady() calls from GPIO interrupt the value is only an upper bound of the real latency
+ * @return Average notice latency in us
+ */
+unsigned long IQRFBase::getAverageNoticeLatency() {
+	return this->polling.getAverageNoticeLatency();
+}
+
+/**
+ * Get count of packets sent to TR module
+ * @return Count of sent packets
+ */
+unsigned long IQRFBase::getTxPacketCount() {
+	return this->statistics.getFramesWritten();
+}
+
+/**
+ * Get count of packets received from TR module
+ * @return Count of received packets
+ */
+unsigned long IQRFBase::getRxPacketCount() {
+	return this->statistics.getFramesRead();
+}
+
+/**
+ * Get snapshot of driver statistics
+ * @param stats Snapshot of statistics
+ */
+void IQRFBase::getStatistics(driverStats_t *stats) {
+	this->statistics.masterState(this->spi.getMasterStatus(), micros());
+	this->statistics.snapshot(stats);
+	stats->txQueueHighWaterMark = this->txQueue.getHighWaterMark();
+	if (this->txQueueHigh.getHighWaterMark() > stats->txQueueHighWaterMark) {
+		stats->txQueueHighWaterMark = this->txQueueHigh.getHighWaterMark();
+	}
+}
+
+/**
+ * Reset driver statistics and high water marks of Tx queues
+ */
+void IQRFBase::resetStatistics() {
+	this->statistics.begin(micros());
+	this->txQueue.resetHighWaterMark();
+	this->txQueueHigh.resetHighWaterMark();
+}
+
+/**
+ * Set PTYPE
+ * @param PTYPE PTYPE
+ */
+void IQRFBase::setPTYPE(uint8_t PTYPE) {
+	this->PTYPE = PTYPE;
+}
+
+/**
+ * Get PTYPE
+ * @return PTYPE
+ */
+uint8_t IQRFBase::getPTYPE() {
+	return this->PTYPE;
+}
+
+/**
+ * Set count of attepmts to send data
+ * @param attepmts Count of attepmts to send data
+ */
+void IQRFBase::setAttepmtsCount(uint8_t attepmts) {
+	this->attepmtsCounter = attepmts;
+}
+
+/**
+ * Get count of attepmts to send data
+ * @return Count of attepmts to send data 
+ */
+uint8_t IQRFBase::getAttepmtsCount() {
+	return this->attepmtsCounter;
+}
+
+/**
+ * Set byte count
+ * @param count Byte count
+ */
+void IQRFBase::setByteCount(uint8_t count) {
+	this->byteCounter = count;
+}
+
+/**
+ * Get byte count
+ * @return Byte count
+ */
+uint8_t IQRFBase::getByteCount() {
+	return this->byteCounter;
+}
+
+/**
+ * Set count of microseconds from counter
+ * @param us Count of microseconds
+ */
+void IQRFBase::setUsCount0(unsigned long us) {
+	this->usCounter0 = us;
+}
+
+/**
+ * Get count of microseconds form counter
+ * @return Count of microseconds
+ */
+unsigned long IQRFBase::getUsCount0() {
+	return this->usCounter0;
+}
+
+/**
+ * Set count of microseconds from counter
+ * @param us Count of microseconds
+ */
+void IQRFBase::setUsCount1(unsigned long us) {
+	this->usCounter1 = us;
+}
+
+/**
+ * Get count of microseconds form counter
+ * @return Count of microseconds
+ */
+unsigned long IQRFBase::getUsCount1() {
+	return this->usCounter1;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFBASE_H
+#define IQRFBASE_H
+
+#include <stdint.h>
+
+#include "IQRFBuffers.h"
+#include "IQRFCallbacks.h"
+#include "IQRFCRC.h"
+#include "IQRFInfoCache.h"
+#include "IQRFPackets.h"
+#include "IQRFPolling.h"
+#include "IQRFRetryPolicy.h"
+#include "IQRFSPI.h"
+#include "IQRFStatistics.h"
+#include "IQRFTR.h"
+#include "IQRFTracker.h"
+#include "IQRFTxQueue.h"
+#include "IQSPI.h"
+
+class IQRFBus;
+
+/**
+ * IQRF SPI driver context, it owns whole state of one TR module driver
+ * Buffers are provided by IQRFDriver, more instances can be used at once
+ */
+class IQRFBase {
+public:
+	void setPins(uint8_t ssPin, uint8_t resetPin);
+	void setBus(IQRFBus *bus);
+	void driver();
+	bool isReady();
+	bool isResetting();
+	uint8_t getSpiStatus();
+	uint8_t endProgramMode();
+	uint8_t sendSpiPacket(uint8_t spiCmd, const uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag, uint8_t priority = IQRFPackets::NORMAL_PRIORITY, IQRFRetryPolicy *retryPolicy = NULL);
+	IQRFTR& getTr();
+	IQRFTracker& getTracker();
+	void setInfoCache(IQRFInfoCache *cache);
+	uint8_t getDataLength();
+	void getData(uint8_t *dataBuffer, uint8_t dataLength);
+	void releaseData(const uint8_t *data);
+	void enableRxQueue();
+	void disableRxQueue();
+	uint8_t available();
+	bool receive(rxPacket_t *packet);
+	unsigned long getRxDropCount();
+	uint8_t sendData(uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag);
+	uint8_t sendData(const uint8_t *dataBuffer, uint8_t dataLength);
+	uint8_t sendData(const uint8_t *dataBuffer, uint8_t dataLength, IQRFRetryPolicy *retryPolicy);
+	uint8_t sendPriorityData(const uint8_t *dataBuffer, uint8_t dataLength, uint8_t priority, IQRFRetryPolicy *retryPolicy = NULL);
+	void setRetryPolicy(IQRFRetryPolicy *retryPolicy);
+	IQRFRetryPolicy& getRetryPolicy();
+	bool canSendData(uint8_t dataLength, uint8_t priority = IQRFPackets::NORMAL_PRIORITY);
+	void setTxPriorityWeight(uint8_t weight);
+	void setTxQueuePolicy(uint8_t policy, unsigned long timeout);
+	bool isTxQueueFull(uint8_t priority = IQRFPackets::NORMAL_PRIORITY);
+	uint8_t getTxQueueFreeSlots(uint8_t priority = IQRFPackets::NORMAL_PRIORITY);
+	uint8_t getTxQueueHighWaterMark(uint8_t priority = IQRFPackets::NORMAL_PRIORITY);
+	unsigned long getTxQueueOverflowCount(uint8_t priority = IQRFPackets::NORMAL_PRIORITY);
+	void enableLog();
+	void disableLog();
+	void enableBurstMode();
+	void disableBurstMode();
+	void enableDrainMode(unsigned long holdTime);
+	void disableDrainMode();
+	unsigned long getFrameTime();
+	uint8_t getFrameResult();
+	unsigned long getAbortedFrameCount();
+	void setPollIntervals(unsigned long minUs, unsigned long maxUs);
+	void dataReady();
+	unsigned long getPollCount();
+	unsigned long getAverageNoticeLatency();
+	unsigned long getTxPacketCount();
+	unsigned long getRxPacketCount();
+	void getStatistics(driverStats_t *stats);
+	void resetStatistics();
+	void setPTYPE(uint8_t PTYPE);
+	uint8_t getPTYPE();
+	void setAttepmtsCount(uint8_t attepmts);
+	uint8_t getAttepmtsCount();
+	void setByteCount(uint8_t count);
+	uint8_t getByteCount();
+	void setUsCount0(unsigned long us);
+	unsigned long getUsCount0();
+	void setUsCount1(unsigned long us);
+	unsigned long getUsCount1();
+protected:
+	void init(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::rxViewCallback_t rxViewCallback, IQRFCallbacks::txCallback_t txCallback);
+	void start(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::rxViewCallback_t rxViewCallback, IQRFCallbacks::txCallback_t txCallback, IQRFCallbacks::readyCallback_t readyCallback);
+	/// Instance of IQRFBuffers class
+	IQRFBuffers buffers;
+	/// Instance of IQRFTxQueue class
+	IQRFTxQueue txQueue;
+	/// Instance of IQRFTxQueue class for high priority packets
+	IQRFTxQueue txQueueHigh;
+private:
+	void infoTask();
+	bool driveBus();
+	void finishInit();
+	bool spiTask();
+	void waitBytePause();
+	bool burstTransfer();
+	bool checkFrameStart();
+	void packetDone();
+	void retryPacket();
+	bool dropExpiredPacket(IQRFTxQueue *queue);
+	void txDone(uint8_t result);
+	bool dropOldestPacket(IQRFTxQueue *queue);
+	IQRFTxQueue* nextTxQueue();
+	IQRFTxQueue* getTxQueue(uint8_t priority);
+	bool acquireRxFrame();
+
+	/**
+	 * TR info reading task statuses
+	 */
+	enum infoTaskStatuses {
+		INIT_TASK = 0, //!< Task initialization
+		ENTER_PROG_MODE = 1, //!< Enter TR module to programming mode
+		SEND_REQUEST = 2, //!< Send request of TR module info
+		WAIT_INFO = 3, //!< Wait for TR module info
+		DONE = 4 //!< TR module info reading is finished
+	};
+
+	/**
+	 * Modes of TR module info reading
+	 */
+	enum idfModes {
+		COM_MODE = 0, //!< Info is read in communication mode
+		PGM_MODE = 1, //!< Info is read in programming mode
+		CACHE_CHECK = 2, //!< Cached info is verified in communication mode
+		CACHE_MISMATCH = 3 //!< Cached info belongs to another TR module
+	};
+	/// Instance of IQRFCallbacks class
+	IQRFCallbacks callbacks;
+	/// Callbacks of application, they are used after TR module info is read
+	IQRFCallbacks appCallbacks;
+	/// Instance of IQRFCRC class
+	IQRFCRC crc;
+	/// Instance of IQRFPackets class
+	IQRFPackets packets;
+	/// Instance of IQRFPolling class
+	IQRFPolling polling;
+	/// Built-in retry policy of Tx packets
+	IQRFRetryPolicy defaultRetryPolicy;
+	/// Retry policy of Tx packets without own retry policy
+	IQRFRetryPolicy *retryPolicy;
+	/// Retry policy of actual Tx packet
+	IQRFRetryPolicy *txRetryPolicy;
+	/// Enqueue time of actual Tx packet in us
+	unsigned long txQueuedUs;
+	/// Start of the first transfer of actual Tx packet in us
+	unsigned long txStartUs;
+	/// Tx queue of actual Tx packet, the packet is removed from it when it is finished
+	IQRFTxQueue *txActiveQueue;
+	/// Time of last failed attempt in us
+	unsigned long retryStartUs;
+	/// Backoff before next attempt in us
+	unsigned long retryBackoff;
+	/// Instance of IQRFSPI class
+	IQRFSPI spi;
+	/// Instance of IQRFStatistics class
+	IQRFStatistics statistics;
+	/// Instance of IQRFTR class
+	IQRFTR tr;
+	/// Instance of IQRFTracker class
+	IQRFTracker tracker;
+	/// Instance of IQSPI class
+	IQSPI iqSpi;
+	/// Data length
+	uint8_t dataLength;
+	/// Driver messages are printed to Serial
+	bool logEnabled = true;
+	/// Driver is running, it must not be called recursively
+	bool driverRunning;
+	/// Driver is initialized and TR module info is read
+	bool ready;
+	/// Count of high priority packets sent in a row while normal priority packets wait
+	uint8_t txHighInRow;
+	/// Start of actual SPI packet transfer in us
+	unsigned long frameStartUs;
+	/// TR info reading task status
+	uint8_t infoTaskStatus;
+	/// Remaining attempts to enter programming mode in TR info reading
+	uint8_t infoAttempts;
+	/// Timeout timer of TR info reading in ms
+	unsigned long infoTimeoutMs;
+	/// Mode of TR info reading
+	uint8_t idfMode;
+	/// Bus shared with other TR modules or NULL
+	IQRFBus *bus = NULL;
+	/// Driver was started by begin(), the bus can call driver of TR module before it
+	bool started = false;
+	/// Persistent cache of TR module info or NULL
+	IQRFInfoCache *infoCache = NULL;
+	/// PTYPE
+	uint8_t PTYPE;
+	/// Count of attempts to send data
+	uint8_t attepmtsCounter;
+	/// Count number of send/receive bytes
+	uint8_t byteCounter;
+	/// Microsecond counter 0
+	unsigned long usCounter0;
+	/// Microsecond counter 1
+	unsigned long usCounter1;
+};
+
+#endif
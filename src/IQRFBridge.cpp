@@ -0,0 +1,319 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFBridge.h"
+
+/// Worst case size of encoded result frame (flags, type, sequence number, result and CRC all escaped)
+#define BRIDGE_RESULT_SIZE (2 + 2 * 4)
+/// Space of ring buffer reserved for results of all credits
+#define BRIDGE_RESULT_RESERVE (BRIDGE_CREDITS * BRIDGE_RESULT_SIZE)
+
+/**
+ * Start the bridge, READY frame with count of credits is sent to host
+ * Rx view callback and Tx callback of the application must pass data to rxDone() and results to txDone()
+ * @param iqrf IQRF driver
+ * @param serial Serial line to host
+ */
+void IQRFBridge::begin(IQRFBase *iqrf, Stream *serial) {
+	this->iqrf = iqrf;
+	this->serial = serial;
+	this->ringTail = 0;
+	this->ringCount = 0;
+	this->ringHighWaterMark = 0;
+	this->hostLength = 0;
+	this->hostEscape = false;
+	this->hostOverflow = false;
+	memset(this->creditPacketIds, 0, sizeof(this->creditPacketIds));
+	this->heldCount = 0;
+	this->hostFrameCounter = 0;
+	this->moduleFrameCounter = 0;
+	this->errorFrameCounter = 0;
+	this->droppedFrameCounter = 0;
+	uint8_t credits = BRIDGE_CREDITS;
+	this->encode(frameTypes::READY, 0, &credits, 1);
+}
+
+/**
+ * Periodically called bridge task, it must be called together with driver
+ * Frames from host are passed to Tx queue, encoded frames for host are written to serial line
+ * by at most BRIDGE_WRITE_SLICE bytes
+ */
+void IQRFBridge::task() {
+	while (this->serial->available() > 0) {
+		this->decode(this->serial->read());
+	}
+	this->flushHeldFrames();
+	this->writeSerial();
+}
+
+/**
+ * Pass data received from TR module to host, it must be called from Rx view callback of the application
+ * Data are released when they are encoded, if ring buffer is full they are held and the driver
+ * stops reading of TR module when all its Rx frames are held
+ * @param data Received data
+ * @param dataLength Length of received data
+ */
+void IQRFBridge::rxDone(const uint8_t *data, uint8_t dataLength) {
+	if (this->heldCount == 0 && this->canEncode(dataLength, BRIDGE_RESULT_RESERVE)) {
+		this->encode(frameTypes::DATA, 0, data, dataLength);
+		this->moduleFrameCounter++;
+		this->iqrf->releaseData(data);
+	} else if (this->heldCount < BRIDGE_HELD_FRAMES) {
+		this->heldData[this->heldCount] = data;
+		this->heldLength[this->heldCount] = dataLength;
+		this->heldCount++;
+	} else {
+		this->droppedFrameCounter++;
+		this->iqrf->releaseData(data);
+	}
+}
+
+/**
+ * Pass result of Tx packet to host, it must be called from Tx callback of the application
+ * @param packetId Packet ID
+ * @param packetResult Packet writing result
+ * @return Packet was sent by the bridge
+ */
+bool IQRFBridge::txDone(uint8_t packetId, uint8_t packetResult) {
+	for (uint8_t i = 0; i < BRIDGE_CREDITS; i++) {
+		if (this->creditPacketIds[i] == packetId) {
+			// space for the result is reserved
+			this->encode(frameTypes::RESULT, this->creditSequences[i], &packetResult, 1);
+			this->creditPacketIds[i] = 0;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Get count of data frames from host
+ * @return Count of data frames from host
+ */
+unsigned long IQRFBridge::getHostFrameCount() {
+	return this->hostFrameCounter;
+}
+
+/**
+ * Get count of data frames from TR module passed to host
+ * @return Count of data frames from TR module
+ */
+unsigned long IQRFBridge::getModuleFrameCount() {
+	return this->moduleFrameCounter;
+}
+
+/**
+ * Get count of frames from host with CRC or format error
+ * @return Count of invalid frames
+ */
+unsigned long IQRFBridge::getErrorFrameCount() {
+	return this->errorFrameCounter;
+}
+
+/**
+ * Get count of frames which were dropped, host exceeded its credits or Tx queue or ring buffer was full
+ * @return Count of dropped frames
+ */
+unsigned long IQRFBridge::getDroppedFrameCount() {
+	return this->droppedFrameCounter;
+}
+
+/**
+ * Get maximal count of bytes in ring buffer, it helps to size BRIDGE_RING_SIZE
+ * @return Maximal count of bytes in ring buffer
+ */
+uint16_t IQRFBridge::getRingHighWaterMark() {
+	return this->ringHighWaterMark;
+}
+
+/**
+ * Check if frame fits into ring buffer in the worst case of escaping
+ * @param dataLength Data length of the frame
+ * @param reserve Space which must stay free
+ * @return Frame fits into ring buffer
+ */
+bool IQRFBridge::canEncode(uint8_t dataLength, uint16_t reserve) {
+	return (uint16_t) (2 + 2 * (dataLength + 3)) + reserve <= BRIDGE_RING_SIZE - this->ringCount;
+}
+
+/**
+ * Encode frame to ring buffer, canEncode() must be checked first
+ * @param type Frame type (see IQRFBridge::frameTypes)
+ * @param sequence Sequence number
+ * @param data Data
+ * @param dataLength Data length
+ */
+void IQRFBridge::encode(uint8_t type, uint8_t sequence, const uint8_t *data, uint8_t dataLength) {
+	this->put(framingBytes::FLAG);
+	this->putEscaped(type);
+	this->putEscaped(sequence);
+	for (uint8_t i = 0; i < dataLength; i++) {
+		this->putEscaped(data[i]);
+	}
+	this->putEscaped(0x5F ^ type ^ sequence ^ this->crc.fold(data, dataLength));
+	this->put(framingBytes::FLAG);
+	if (this->ringCount > this->ringHighWaterMark) {
+		this->ringHighWaterMark = this->ringCount;
+	}
+}
+
+/**
+ * Put byte to ring buffer
+ * @param data Byte
+ */
+void IQRFBridge::put(uint8_t data) {
+	uint16_t head = this->ringTail + this->ringCount;
+	if (head >= BRIDGE_RING_SIZE) {
+		head -= BRIDGE_RING_SIZE;
+	}
+	this->ring[head] = data;
+	this->ringCount++;
+}
+
+/**
+ * Put byte of frame to ring buffer, flag and escape bytes are escaped
+ * @param data Byte
+ */
+void IQRFBridge::putEscaped(uint8_t data) {
+	if (data == framingBytes::FLAG || data == framingBytes::ESCAPE) {
+		this->put(framingBytes::ESCAPE);
+		data ^= framingBytes::ESCAPE_XOR;
+	}
+	this->put(data);
+}
+
+/**
+ * Decode one byte from host
+ * @param data Byte
+ */
+void IQRFBridge::decode(uint8_t data) {
+	if (data == framingBytes::FLAG) {
+		if (this->hostOverflow || this->hostEscape) {
+			this->errorFrameCounter++;
+		} else if (this->hostLength) {
+			this->hostFrame();
+		}
+		// flags between frames are ignored
+		this->hostLength = 0;
+		this->hostEscape = false;
+		this->hostOverflow = false;
+		return;
+	}
+	if (this->hostOverflow) {
+		return;
+	}
+	if (data == framingBytes::ESCAPE) {
+		this->hostEscape = true;
+		return;
+	}
+	if (this->hostEscape) {
+		data ^= framingBytes::ESCAPE_XOR;
+		this->hostEscape = false;
+	}
+	if (this->hostLength == sizeof(this->hostBuffer)) {
+		this->hostOverflow = true;
+		return;
+	}
+	this->hostBuffer[this->hostLength++] = data;
+}
+
+/**
+ * Process complete frame from host, data frame is passed to Tx queue
+ */
+void IQRFBridge::hostFrame() {
+	// type, sequence number, at least one data byte and CRC, XOR of all bytes with CRC is 0x5F
+	if (this->hostLength < 4 || this->hostLength > PACKET_SIZE - 1 || this->hostBuffer[0] != frameTypes::DATA ||
+		this->crc.fold(this->hostBuffer, this->hostLength) != 0x5F) {
+		this->errorFrameCounter++;
+		return;
+	}
+	this->hostFrameCounter++;
+	uint8_t sequence = this->hostBuffer[1];
+	uint8_t packetResult = IQRFPackets::statuses::DROPPED;
+	for (uint8_t i = 0; i < BRIDGE_CREDITS; i++) {
+		if (this->creditPacketIds[i] == 0) {
+			uint8_t packetId = this->iqrf->sendData((const uint8_t *) &this->hostBuffer[2], this->hostLength - 3);
+			if (packetId) {
+				this->creditPacketIds[i] = packetId;
+				this->creditSequences[i] = sequence;
+				return;
+			}
+			break;
+		}
+	}
+	// host exceeded its credits or Tx queue is full, the frame is rejected at once
+	// reserved space belongs to results of accepted frames, without space only the drop is counted
+	this->droppedFrameCounter++;
+	if (this->canEncode(1, BRIDGE_RESULT_RESERVE)) {
+		this->encode(frameTypes::RESULT, sequence, &packetResult, 1);
+	}
+}
+
+/**
+ * Encode held data from TR module when ring buffer has space and release them
+ */
+void IQRFBridge::flushHeldFrames() {
+	while (this->heldCount && this->canEncode(this->heldLength[0], BRIDGE_RESULT_RESERVE)) {
+		const uint8_t *data = this->heldData[0];
+		this->encode(frameTypes::DATA, 0, data, this->heldLength[0]);
+		this->moduleFrameCounter++;
+		this->heldCount--;
+		for (uint8_t i = 0; i < this->heldCount; i++) {
+			this->heldData[i] = this->heldData[i + 1];
+			this->heldLength[i] = this->heldLength[i + 1];
+		}
+		this->iqrf->releaseData(data);
+	}
+}
+
+/**
+ * Write encoded frames from ring buffer to serial line
+ * Only free space of serial Tx buffer is written, so the task does not block,
+ * ring buffer is advanced by count of bytes accepted by the serial line
+ */
+void IQRFBridge::writeSerial() {
+	uint16_t length = this->ringCount;
+	if (length > BRIDGE_WRITE_SLICE) {
+		length = BRIDGE_WRITE_SLICE;
+	}
+	if (length > BRIDGE_RING_SIZE - this->ringTail) {
+		// the rest is written in next call
+		length = BRIDGE_RING_SIZE - this->ringTail;
+	}
+#if BRIDGE_WRITE_AVAILABLE
+	int space = this->serial->availableForWrite();
+	if (space <= 0) {
+		return;
+	}
+	if (length > (uint16_t) space) {
+		length = space;
+	}
+#endif
+	if (length == 0) {
+		return;
+	}
+	uint16_t written = this->serial->write(&this->ring[this->ringTail], length);
+	this->ringTail += written;
+	if (this->ringTail == BRIDGE_RING_SIZE) {
+		this->ringTail = 0;
+	}
+	this->ringCount -= written;
+}
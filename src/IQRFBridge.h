@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFBRIDGE_H
+#define IQRFBRIDGE_H
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stdint.h>
+
+#include "IQRFBase.h"
+#include "IQRFCRC.h"
+#include "IQRFSettings.h"
+
+/**
+ * Transparent bridge between host on a serial line and TR module
+ * Frames on the serial line are delimited by flag byte 0x7E, bytes 0x7E and 0x7D inside
+ * a frame are escaped by 0x7D and XOR 0x20. Frame is type, sequence number, data and CRC.
+ * Host may have at most BRIDGE_CREDITS data frames without result frame.
+ */
+class IQRFBridge {
+public:
+	void begin(IQRFBase *iqrf, Stream *serial);
+	void task();
+	void rxDone(const uint8_t *data, uint8_t dataLength);
+	bool txDone(uint8_t packetId, uint8_t packetResult);
+	unsigned long getHostFrameCount();
+	unsigned long getModuleFrameCount();
+	unsigned long getErrorFrameCount();
+	unsigned long getDroppedFrameCount();
+	uint16_t getRingHighWaterMark();
+
+	/**
+	 * Types of frames
+	 */
+	enum frameTypes {
+		DATA = 0x01, //!< Data of SPI packet, from host or from TR module (sequence number 0)
+		RESULT = 0x02, //!< Result of data frame from host (see IQRFPackets::statuses)
+		READY = 0x03 //!< Bridge was started, data contain count of credits
+	};
+
+	/**
+	 * Special bytes of framing
+	 */
+	enum framingBytes {
+		FLAG = 0x7E, //!< Start and end of frame
+		ESCAPE = 0x7D, //!< Next byte is XORed with ESCAPE_XOR
+		ESCAPE_XOR = 0x20 //!< XOR of escaped byte
+	};
+private:
+	bool canEncode(uint8_t dataLength, uint16_t reserve);
+	void encode(uint8_t type, uint8_t sequence, const uint8_t *data, uint8_t dataLength);
+	void put(uint8_t data);
+	void putEscaped(uint8_t data);
+	void decode(uint8_t data);
+	void hostFrame();
+	void flushHeldFrames();
+	void writeSerial();
+	/// IQRF driver
+	IQRFBase *iqrf;
+	/// Serial line to host
+	Stream *serial;
+	/// Instance of IQRFCRC class
+	IQRFCRC crc;
+	/// Ring buffer of encoded frames for host
+	uint8_t ring[BRIDGE_RING_SIZE];
+	/// Index of the first byte in ring buffer
+	uint16_t ringTail;
+	/// Count of bytes in ring buffer
+	uint16_t ringCount;
+	/// Maximal count of bytes in ring buffer
+	uint16_t ringHighWaterMark;
+	/// Frame from host (type, sequence number, data and CRC)
+	uint8_t hostBuffer[PACKET_SIZE];
+	/// Received length of frame from host
+	uint8_t hostLength;
+	/// Next byte from host is escaped
+	bool hostEscape;
+	/// Frame from host is too long, it is dropped until next flag
+	bool hostOverflow;
+	/// IDs of Tx packets from host without result
+	uint8_t creditPacketIds[BRIDGE_CREDITS];
+	/// Sequence numbers of Tx packets from host without result
+	uint8_t creditSequences[BRIDGE_CREDITS];
+	/// Received data held until they fit into ring buffer
+	const uint8_t *heldData[BRIDGE_HELD_FRAMES];
+	/// Lengths of held data
+	uint8_t heldLength[BRIDGE_HELD_FRAMES];
+	/// Count of held data
+	uint8_t heldCount;
+	/// Count of data frames from host
+	unsigned long hostFrameCounter;
+	/// Count of data frames from TR module
+	unsigned long moduleFrameCounter;
+	/// Count of frames from host with CRC or format error
+	unsigned long errorFrameCounter;
+	/// Count of frames which were dropped
+	unsigned long droppedFrameCounter;
+};
+
+#endif
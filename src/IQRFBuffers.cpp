@@ -21,6 +21,33 @@
 
 #include "IQRFBuffers.h"
 
+/**
+ * Attach Rx frames, all frames are freed and Rx queue is emptied and disabled
+ * Rx queue holds at most RX_QUEUE_DEPTH frames and less than all Rx frames if there are more of them,
+ * so queued frames do not take the frame needed for reading of TR module
+ * @param rxFrames Rx frames
+ * @param rxQueue Rx queue of frame indexes, one item per Rx frame
+ * @param rxFrameCount Count of Rx frames
+ */
+void IQRFBuffers::begin(rxFrame_t *rxFrames, uint8_t *rxQueue, uint8_t rxFrameCount) {
+	this->rxFrames = rxFrames;
+	this->rxQueue = rxQueue;
+	this->rxFrameCount = rxFrameCount;
+	this->rxQueueOutPtr = 0;
+	this->rxQueueCount = 0;
+	this->rxQueueDepth = (rxFrameCount > 1) ? rxFrameCount - 1 : 1;
+	if (this->rxQueueDepth > RX_QUEUE_DEPTH) {
+		this->rxQueueDepth = RX_QUEUE_DEPTH;
+	}
+	this->rxQueueEnabled = false;
+	this->rxDropCounter = 0;
+	for (uint8_t i = 0; i < rxFrameCount; i++) {
+		this->rxFrames[i].status = rxFrameStatuses::FREE;
+	}
+	this->rxFrameIndex = 0;
+	this->rxBuffer = this->rxFrames[0].data;
+}
+
 /**
  * Get Rx buffer
  * @return Rx buffer
@@ -34,7 +61,7 @@ uint8_t* IQRFBuffers::getRxBuffer() {
  * @return Rx buffer size
  */
 uint8_t IQRFBuffers::getRxBufferSize() {
-	return sizeof(this->rxBuffer);
+	return PACKET_SIZE;
 }
 
 /**
@@ -55,6 +82,154 @@ void IQRFBuffers::setRxData(uint8_t position, uint8_t data) {
 	this->rxBuffer[position] = data;
 }
 
+/**
+ * Use free Rx frame as Rx buffer for next SPI transfer
+ * @return Free Rx frame was found
+ */
+bool IQRFBuffers::acquireRxFrame() {
+	for (uint8_t i = 0; i < this->rxFrameCount; i++) {
+		if (this->rxFrames[i].status == rxFrameStatuses::FREE) {
+			this->rxFrameIndex = i;
+			this->rxBuffer = this->rxFrames[i].data;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Hold actual Rx buffer for application, it is not used for SPI transfer until released
+ * @return Held Rx buffer
+ */
+uint8_t* IQRFBuffers::holdRxFrame() {
+	this->rxFrames[this->rxFrameIndex].status = rxFrameStatuses::HELD;
+	return this->rxBuffer;
+}
+
+/**
+ * Release Rx frame held by application
+ * @param data Pointer to data in held Rx frame
+ */
+void IQRFBuffers::releaseRxFrame(const uint8_t *data) {
+	for (uint8_t i = 0; i < this->rxFrameCount; i++) {
+		if (data >= this->rxFrames[i].data && data < &this->rxFrames[i].data[PACKET_SIZE]) {
+			this->rxFrames[i].status = rxFrameStatuses::FREE;
+			return;
+		}
+	}
+}
+
+/**
+ * Get count of Rx frames usable for SPI transfer
+ * @return Count of free Rx frames
+ */
+uint8_t IQRFBuffers::getFreeRxFrames() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < this->rxFrameCount; i++) {
+		if (this->rxFrames[i].status == rxFrameStatuses::FREE) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Enable Rx queue, received frames are queued instead of calling Rx callback
+ */
+void IQRFBuffers::enableRxQueue() {
+	this->rxQueueEnabled = true;
+}
+
+/**
+ * Disable Rx queue
+ */
+void IQRFBuffers::disableRxQueue() {
+	this->rxQueueEnabled = false;
+}
+
+/**
+ * Get Rx queue status
+ * @return Rx queue is enabled
+ */
+bool IQRFBuffers::isRxQueueEnabled() {
+	return this->rxQueueEnabled;
+}
+
+/**
+ * Put actual Rx buffer to the end of Rx queue, the oldest frame is dropped from full Rx queue
+ * @param dataLength Data length
+ * @param timestamp Time of reception in us
+ */
+void IQRFBuffers::queueRxFrame(uint8_t dataLength, unsigned long timestamp) {
+	if (this->rxQueueCount >= this->rxQueueDepth) {
+		this->dropRxFrame();
+	}
+	rxFrame_t *frame = &this->rxFrames[this->rxFrameIndex];
+	uint8_t inPtr = this->rxQueueOutPtr + this->rxQueueCount;
+	if (inPtr >= this->rxFrameCount) {
+		inPtr -= this->rxFrameCount;
+	}
+	frame->status = rxFrameStatuses::QUEUED;
+	frame->dataLength = dataLength;
+	frame->timestamp = timestamp;
+	this->rxQueue[inPtr] = this->rxFrameIndex;
+	this->rxQueueCount++;
+}
+
+/**
+ * Get count of frames in Rx queue
+ * @return Count of frames in Rx queue
+ */
+uint8_t IQRFBuffers::getQueuedRxFrames() {
+	return this->rxQueueCount;
+}
+
+/**
+ * Take the oldest frame from Rx queue, frame is held until released
+ * @param packet Received packet
+ * @return Rx queue was not empty
+ */
+bool IQRFBuffers::dequeueRxFrame(rxPacket_t *packet) {
+	if (this->rxQueueCount == 0) {
+		return false;
+	}
+	rxFrame_t *frame = &this->rxFrames[this->rxQueue[this->rxQueueOutPtr]];
+	if (++this->rxQueueOutPtr >= this->rxFrameCount) {
+		this->rxQueueOutPtr = 0;
+	}
+	this->rxQueueCount--;
+	frame->status = rxFrameStatuses::HELD;
+	packet->data = &frame->data[2];
+	packet->dataLength = frame->dataLength;
+	packet->timestamp = frame->timestamp;
+	return true;
+}
+
+/**
+ * Drop the oldest frame from Rx queue
+ * @return Rx queue was not empty
+ */
+bool IQRFBuffers::dropRxFrame() {
+	if (this->rxQueueCount == 0) {
+		return false;
+	}
+	this->rxFrames[this->rxQueue[this->rxQueueOutPtr]].status = rxFrameStatuses::FREE;
+	if (++this->rxQueueOutPtr >= this->rxFrameCount) {
+		this->rxQueueOutPtr = 0;
+	}
+	this->rxQueueCount--;
+	this->rxDropCounter++;
+	return true;
+}
+
+/**
+ * Get count of frames dropped from full Rx queue
+ * @return Count of dropped frames
+ */
+unsigned long IQRFBuffers::getRxDropCount() {
+	return this->rxDropCounter;
+}
+
 /**
  * Get Tx buffer
  * @return Tx buffer
@@ -26,8 +26,32 @@
 
 #include "IQRFSettings.h"
 
+/**
+ * Received packet
+ */
+typedef struct {
+	const uint8_t *data; //!< Pointer to received data, valid until released
+	uint8_t dataLength; //!< Data length
+	unsigned long timestamp; //!< Time of reception in us
+} rxPacket_t;
+
+/**
+ * Rx frame, storage for one SPI packet read from TR module
+ */
+typedef struct {
+	uint8_t data[PACKET_SIZE]; //!< SPI packet
+	uint8_t status; //!< Rx frame status
+	uint8_t dataLength; //!< Data length of queued frame
+	unsigned long timestamp; //!< Reception time of queued frame in us
+} rxFrame_t;
+
+/**
+ * IQRF SPI buffers, Rx buffer is one of the Rx frames
+ * Rx frames are provided by IQRFStorage, see IQRFDriver.h
+ */
 class IQRFBuffers {
 public:
+	void begin(rxFrame_t *rxFrames, uint8_t *rxQueue, uint8_t rxFrameCount);
 	uint8_t* getTxBuffer();
 	uint8_t getTxBufferSize();
 	uint8_t getTxData(uint8_t position);
@@ -36,11 +60,50 @@ public:
 	uint8_t getRxBufferSize();
 	uint8_t getRxData(uint8_t position);
 	void setRxData(uint8_t position, uint8_t data);
+	bool acquireRxFrame();
+	uint8_t* holdRxFrame();
+	void releaseRxFrame(const uint8_t *data);
+	uint8_t getFreeRxFrames();
+	void enableRxQueue();
+	void disableRxQueue();
+	bool isRxQueueEnabled();
+	void queueRxFrame(uint8_t dataLength, unsigned long timestamp);
+	uint8_t getQueuedRxFrames();
+	bool dequeueRxFrame(rxPacket_t *packet);
+	bool dropRxFrame();
+	unsigned long getRxDropCount();
+
+	/**
+	 * Rx frame statuses
+	 */
+	enum rxFrameStatuses {
+		FREE = 0, //!< Rx frame can be used for SPI transfer
+		HELD = 1, //!< Rx frame is held by application
+		QUEUED = 2 //!< Rx frame is waiting in Rx queue
+	};
 private:
-	/// SPI Rx buffer
-	uint8_t rxBuffer[PACKET_SIZE];
+	/// SPI Rx frames
+	rxFrame_t *rxFrames;
+	/// Count of Rx frames
+	uint8_t rxFrameCount;
+	/// Rx queue of frame indexes
+	uint8_t *rxQueue;
+	/// Rx queue output pointer
+	uint8_t rxQueueOutPtr;
+	/// Count of frames in Rx queue
+	uint8_t rxQueueCount;
+	/// Maximal count of frames in Rx queue
+	uint8_t rxQueueDepth;
+	/// Rx queue enabled
+	bool rxQueueEnabled;
+	/// Count of Rx frames dropped from full Rx queue
+	unsigned long rxDropCounter;
 	/// SPI Tx buffer
 	uint8_t txBuffer[PACKET_SIZE];
+	/// Index of Rx frame used as actual SPI Rx buffer
+	uint8_t rxFrameIndex;
+	/// Actual SPI Rx buffer
+	uint8_t *rxBuffer = txBuffer;
 };
 
 #endif
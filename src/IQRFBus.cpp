@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include "IQRFBus.h"
+
+/**
+ * Initialize scheduler without TR modules
+ */
+void IQRFBus::begin() {
+	this->moduleCount = 0;
+	this->firstModule = 0;
+	this->running = false;
+	this->resetCounters();
+}
+
+/**
+ * Add TR module to scheduler, begin() of TR module is called by application
+ * @param module TR module driver
+ * @return TR module was added, false if IQRF_BUS_MODULES modules are already added
+ */
+bool IQRFBus::add(IQRFBase *module) {
+	if (this->moduleCount >= IQRF_BUS_MODULES) {
+		return false;
+	}
+	this->modules[this->moduleCount] = module;
+	// blocking calls of the module drive the whole bus
+	module->setBus(this);
+	this->grantCounter[this->moduleCount] = 0;
+	this->busTime[this->moduleCount] = 0;
+	this->lastGrantUs[this->moduleCount] = micros();
+	this->maxWaitUs[this->moduleCount] = 0;
+	this->moduleCount++;
+	return true;
+}
+
+/**
+ * Get count of TR modules
+ * @return Count of TR modules
+ */
+uint8_t IQRFBus::getModuleCount() {
+	return this->moduleCount;
+}
+
+/**
+ * Get TR module
+ * @param index TR module index (order of add() calls)
+ * @return TR module driver or NULL
+ */
+IQRFBase* IQRFBus::getModule(uint8_t index) {
+	if (index >= this->moduleCount) {
+		return NULL;
+	}
+	return this->modules[index];
+}
+
+/**
+ * Periodically called driver of all TR modules
+ * Every TR module gets one driver call, the module served first rotates,
+ * so in drain mode the hold time is shared equally
+ * While a TR module is reset, only its driver is called, also in the rest of the round in which the reset starts
+ */
+void IQRFBus::driver() {
+	if (this->running) {
+		return;
+	}
+	this->running = true;
+	// TR module in reset drives SPI pins, other modules wait for it
+	for (uint8_t i = 0; i < this->moduleCount; i++) {
+		if (this->modules[i]->isResetting()) {
+			this->modules[i]->driver();
+			this->running = false;
+			return;
+		}
+	}
+	uint8_t index = this->firstModule;
+	for (uint8_t i = 0; i < this->moduleCount; i++) {
+		unsigned long startUs = micros();
+		if (startUs - this->lastGrantUs[index] > this->maxWaitUs[index]) {
+			this->maxWaitUs[index] = startUs - this->lastGrantUs[index];
+		}
+		this->modules[index]->driver();
+		this->lastGrantUs[index] = micros();
+		this->busTime[index] += this->lastGrantUs[index] - startUs;
+		this->grantCounter[index]++;
+		if (this->modules[index]->isResetting()) {
+			// TR module started reset in its driver call, rest of the modules waits for it
+			break;
+		}
+		if (++index >= this->moduleCount) {
+			index = 0;
+		}
+	}
+	if (++this->firstModule >= this->moduleCount) {
+		this->firstModule = 0;
+	}
+	this->running = false;
+}
+
+/**
+ * Check if drivers of TR modules are being called, bus driver can not be entered again from callbacks
+ * @return Bus driver is running
+ */
+bool IQRFBus::isRunning() {
+	return this->running;
+}
+
+/**
+ * Get count of driver calls of TR module
+ * @param index TR module index
+ * @return Count of driver calls
+ */
+unsigned long IQRFBus::getGrantCount(uint8_t index) {
+	return this->grantCounter[index];
+}
+
+/**
+ * Get time spent in driver calls of TR module, it includes SPI transfers and byte pauses inside bursts
+ * @param index TR module index
+ * @return Bus time in us
+ */
+unsigned long IQRFBus::getBusTime(uint8_t index) {
+	return this->busTime[index];
+}
+
+/**
+ * Get maximal time between two driver calls of TR module
+ * @param index TR module index
+ * @return Maximal wait time in us
+ */
+unsigned long IQRFBus::getMaxWaitTime(uint8_t index) {
+	return this->maxWaitUs[index];
+}
+
+/**
+ * Get Jain's fairness index of bus time
+ * Index is 1 when all TR modules got the same bus time and 1/n when one module got all of it,
+ * it is meaningful when all TR modules have traffic
+ * @return Fairness index
+ */
+float IQRFBus::getFairness() {
+	float sum = 0;
+	float sumOfSquares = 0;
+	for (uint8_t i = 0; i < this->moduleCount; i++) {
+		sum += this->busTime[i];
+		sumOfSquares += (float) this->busTime[i] * this->busTime[i];
+	}
+	if (sumOfSquares == 0) {
+		return 1;
+	}
+	return sum * sum / (this->moduleCount * sumOfSquares);
+}
+
+/**
+ * Reset statistics of all TR modules
+ */
+void IQRFBus::resetCounters() {
+	unsigned long nowUs = micros();
+	for (uint8_t i = 0; i < this->moduleCount; i++) {
+		this->grantCounter[i] = 0;
+		this->busTime[i] = 0;
+		this->lastGrantUs[i] = nowUs;
+		this->maxWaitUs[i] = 0;
+	}
+}
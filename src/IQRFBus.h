@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFBUS_H
+#define IQRFBUS_H
+
+#include <stdint.h>
+
+#include "IQRFBase.h"
+#include "IQRFSettings.h"
+
+/**
+ * Round-robin scheduler of TR modules sharing one SPI bus
+ * Each TR module has own SS and reset pins (see IQRFBase::setPins()) and own Tx/Rx queues,
+ * driver() gives every TR module one driver call, so no module starves
+ */
+class IQRFBus {
+public:
+	void begin();
+	bool add(IQRFBase *module);
+	uint8_t getModuleCount();
+	IQRFBase* getModule(uint8_t index);
+	void driver();
+	bool isRunning();
+	unsigned long getGrantCount(uint8_t index);
+	unsigned long getBusTime(uint8_t index);
+	unsigned long getMaxWaitTime(uint8_t index);
+	float getFairness();
+	void resetCounters();
+private:
+	/// TR modules
+	IQRFBase *modules[IQRF_BUS_MODULES];
+	/// Count of TR modules
+	uint8_t moduleCount;
+	/// Drivers of TR modules are being called
+	bool running;
+	/// TR module served first in next driver() call
+	uint8_t firstModule;
+	/// Count of driver calls of each TR module
+	unsigned long grantCounter[IQRF_BUS_MODULES];
+	/// Time spent in driver calls of each TR module in us
+	unsigned long busTime[IQRF_BUS_MODULES];
+	/// End of last driver call of each TR module in us
+	unsigned long lastGrantUs[IQRF_BUS_MODULES];
+	/// Maximal time between driver calls of each TR module in us
+	unsigned long maxWaitUs[IQRF_BUS_MODULES];
+};
+
+#endif
@@ -18,6 +18,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <string.h>
+
 #include "IQRFCRC.h"
 
 /**
@@ -34,6 +36,17 @@ uint8_t IQRFCRC::calculate(uint8_t *buffer, uint8_t dataLength) {
 	return crc;
 }
 
+/**
+ * Calculate CRC before master's send from data CRC folded in advance
+ * @param spiCmd SPI command
+ * @param type Type (PTYPE)
+ * @param dataCrc Data folded by fold()
+ * @return CRC
+ */
+uint8_t IQRFCRC::calculate(uint8_t spiCmd, uint8_t type, uint8_t dataCrc) {
+	return 0x5F ^ spiCmd ^ type ^ dataCrc;
+}
+
 /**
  * Confirm CRC from SPI slave upon received data
  * @param buffer SPI Rx buffer
@@ -54,3 +67,76 @@ bool IQRFCRC::check(uint8_t *buffer, uint8_t dataLength, uint8_t type) {
 		return false;
 	}
 }
+
+/**
+ * Fold data to one byte by XOR, on 32-bit MCU four bytes are folded at once
+ * @param data Data
+ * @param dataLength Data length
+ * @return Folded data
+ */
+uint8_t IQRFCRC::fold(const uint8_t *data, uint8_t dataLength) {
+	uint8_t crc = 0;
+#if defined(__arm__) || defined(__PIC32MX__)
+	while (dataLength && ((uintptr_t) data & 0x03)) {
+		crc ^= *data++;
+		dataLength--;
+	}
+	uint32_t word = 0;
+	for (; dataLength >= 4; dataLength -= 4, data += 4) {
+		uint32_t part;
+		memcpy(&part, data, 4);
+		word ^= part;
+	}
+	word ^= word >> 16;
+	word ^= word >> 8;
+	crc ^= (uint8_t) word;
+#endif
+	while (dataLength--) {
+		crc ^= *data++;
+	}
+	return crc;
+}
+
+/**
+ * Start CRCS calculation of received packet
+ * @param type Type (PTYPE)
+ */
+void IQRFCRC::begin(uint8_t type) {
+	this->crcs = 0x5F ^ type;
+}
+
+/**
+ * Fold received data byte to CRCS
+ * @param data Received data byte
+ */
+void IQRFCRC::update(uint8_t data) {
+	this->crcs ^= data;
+}
+
+/**
+ * Fold received block to CRCS, only data bytes of SPI packet are used
+ * @param buffer SPI Rx buffer
+ * @param first Position of first byte of the block
+ * @param last Position after last byte of the block
+ * @param dataLength Data length
+ * @param blockCrc XOR of all bytes of the block
+ */
+void IQRFCRC::update(uint8_t *buffer, uint8_t first, uint8_t last, uint8_t dataLength, uint8_t blockCrc) {
+	// remove CMD, PTYPE, CRCS and status bytes
+	for (uint8_t i = first; i < 2 && i < last; i++) {
+		blockCrc ^= buffer[i];
+	}
+	for (uint8_t i = (first > dataLength + 2) ? first : dataLength + 2; i < last; i++) {
+		blockCrc ^= buffer[i];
+	}
+	this->crcs ^= blockCrc;
+}
+
+/**
+ * Compare received CRCS with CRCS folded during the transfer
+ * @param crcs Received CRCS
+ * @return CRCS ok
+ */
+bool IQRFCRC::isValid(uint8_t crcs) {
+	return this->crcs == crcs;
+}
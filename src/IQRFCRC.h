@@ -26,11 +26,22 @@
 
 /**
  * IQRF CRC class
+ * CRC of IQRF SPI is XOR, so it can be folded from parts: CRCM from data folded
+ * when the packet is queued and CRCS from bytes received during the transfer
  */
 class IQRFCRC {
 public:
 	uint8_t calculate(uint8_t *buffer, uint8_t dataLength);
+	uint8_t calculate(uint8_t spiCmd, uint8_t type, uint8_t dataCrc);
 	bool check(uint8_t *buffer, uint8_t dataLength, uint8_t type);
+	uint8_t fold(const uint8_t *data, uint8_t dataLength);
+	void begin(uint8_t type);
+	void update(uint8_t data);
+	void update(uint8_t *buffer, uint8_t first, uint8_t last, uint8_t dataLength, uint8_t blockCrc);
+	bool isValid(uint8_t crcs);
+private:
+	/// CRCS of bytes received so far
+	uint8_t crcs;
 };
 
 #endif
@@ -36,6 +36,31 @@ void IQRFCallbacks::callRxCallback() {
 	this->rxCallback();
 }
 
+/**
+ * Set Rx view callback, it is used instead of Rx callback
+ * @param callback Rx view callback or NULL
+ */
+void IQRFCallbacks::setRxViewCallback(rxViewCallback_t callback) {
+	this->rxViewCallback = callback;
+}
+
+/**
+ * Check if Rx view callback is set
+ * @return Rx view callback is set
+ */
+bool IQRFCallbacks::hasRxViewCallback() {
+	return this->rxViewCallback != NULL;
+}
+
+/**
+ * Call Rx view callback
+ * @param data Pointer to received data
+ * @param dataLength Length of received data
+ */
+void IQRFCallbacks::callRxViewCallback(const uint8_t *data, uint8_t dataLength) {
+	this->rxViewCallback(data, dataLength);
+}
+
 /**
  * Set Tx callback
  * @param callback Tx callback
@@ -52,3 +77,20 @@ void IQRFCallbacks::setTxCallback(txCallback_t callback) {
 void IQRFCallbacks::callTxCallback(uint8_t packetId, uint8_t packetResult) {
 	this->txCallback(packetId, packetResult);
 }
+
+/**
+ * Set ready callback
+ * @param callback Ready callback or NULL
+ */
+void IQRFCallbacks::setReadyCallback(readyCallback_t callback) {
+	this->readyCallback = callback;
+}
+
+/**
+ * Call ready callback if it is set
+ */
+void IQRFCallbacks::callReadyCallback() {
+	if (this->readyCallback != NULL) {
+		this->readyCallback();
+	}
+}
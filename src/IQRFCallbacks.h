@@ -22,23 +22,37 @@
 #ifndef IQRFCALLBACKS_H
 #define IQRFCALLBACKS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 class IQRFCallbacks {
 public:
 	/// SPI RX data callback function type
 	typedef void (*rxCallback_t)(void);
+	/// SPI RX data view callback function type, data are valid until released
+	typedef void (*rxViewCallback_t)(const uint8_t *data, uint8_t dataLength);
 	/// SPI TX data callback function type
 	typedef void (*txCallback_t)(uint8_t packetId, uint8_t packetResult);
+	/// Driver ready callback function type
+	typedef void (*readyCallback_t)(void);
 	void setRxCallback(rxCallback_t callback);
 	void callRxCallback();
+	void setRxViewCallback(rxViewCallback_t callback);
+	bool hasRxViewCallback();
+	void callRxViewCallback(const uint8_t *data, uint8_t dataLength);
 	void setTxCallback(txCallback_t callback);
 	void callTxCallback(uint8_t packetId, uint8_t packetResult);
+	void setReadyCallback(readyCallback_t callback);
+	void callReadyCallback();
 private:
 	/// Rx callback function
 	rxCallback_t rxCallback;
+	/// Rx view callback function
+	rxViewCallback_t rxViewCallback;
 	/// Tx callback function
 	txCallback_t txCallback;
+	/// Ready callback function
+	readyCallback_t readyCallback;
 };
 
 #endif
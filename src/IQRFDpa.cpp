@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFDpa.h"
+
+/**
+ * Initialize DPA layer, outstanding requests are forgotten
+ * Rx and Tx callbacks of the application must pass received data to rxDone() and results of Tx packets to txDone()
+ * @param iqrf IQRF driver
+ */
+void IQRFDpa::begin(IQRFBase *iqrf) {
+	this->iqrf = iqrf;
+	memset(this->requests, 0, sizeof(this->requests));
+	this->lastRequestId = 0;
+	this->timeoutCounter = 0;
+	this->sending = false;
+}
+
+/**
+ * Send DPA request, more requests can be outstanding at once if they differ in NADR, PNUM or PCMD
+ * @param nadr Network address
+ * @param pnum Peripheral number
+ * @param pcmd Peripheral command
+ * @param hwpid Hardware profile ID
+ * @param data PData of the request, data are copied
+ * @param dataLength Length of PData
+ * @param handler Completion handler, it is called from Rx or Tx callback or from task(),
+ *                every request gets one final result (RESPONSE, TX_ERROR, TIMEOUT or BROADCAST_DONE)
+ * @param timeout Timeout of response from transfer of the request to TR module in ms, it is restarted by confirmation
+ * @return Request ID (number 1-255) or 0 if the request was rejected, it is rejected also when send() is called
+ *         from a callback which runs inside of another send() (Tx packet dropped or Tx queue drained by BLOCK policy)
+ */
+uint8_t IQRFDpa::send(uint16_t nadr, uint8_t pnum, uint8_t pcmd, uint16_t hwpid, const uint8_t *data, uint8_t dataLength, handler_t handler, unsigned long timeout) {
+	pcmd &= ~dpaConstants::RESPONSE_FLAG;
+	if (this->sending || dataLength > sizeof(this->frame) - dpaConstants::HEADER_LENGTH || this->find(nadr, pnum, pcmd) != NULL) {
+		// response could not be matched to the request
+		return 0;
+	}
+	dpaRequest_t *request = this->findFree();
+	if (request == NULL) {
+		return 0;
+	}
+	this->frame[0] = nadr & 0xFF;
+	this->frame[1] = nadr >> 8;
+	this->frame[2] = pnum;
+	this->frame[3] = pcmd;
+	this->frame[4] = hwpid & 0xFF;
+	this->frame[5] = hwpid >> 8;
+	memcpy(&this->frame[dpaConstants::HEADER_LENGTH], data, dataLength);
+	// callbacks inside of sendData() must not take the free slot or overwrite the frame
+	this->sending = true;
+	uint8_t packetId = this->iqrf->sendData(this->frame, dpaConstants::HEADER_LENGTH + dataLength);
+	this->sending = false;
+	if (!packetId) {
+		return 0;
+	}
+	request->requestId = this->newRequestId();
+	request->packetId = packetId;
+	request->nadr = nadr;
+	request->pnum = pnum;
+	request->pcmd = pcmd;
+	request->handler = handler;
+	request->startMs = millis();
+	request->timeout = timeout;
+	return request->requestId;
+}
+
+/**
+ * Process data received from TR module, it must be called from Rx callback of the application
+ * Confirmation restarts timeout of the request extended by routing time announced by coordinator
+ * @param data Received data
+ * @param dataLength Length of received data
+ * @return Data were response or confirmation of an outstanding request, otherwise application processes them
+ */
+bool IQRFDpa::rxDone(const uint8_t *data, uint8_t dataLength) {
+	if (dataLength < dpaConstants::RESPONSE_HEADER_LENGTH) {
+		return false;
+	}
+	dpaResponse_t response;
+	response.nadr = data[0] | ((uint16_t) data[1] << 8);
+	response.pnum = data[2];
+	response.pcmd = data[3];
+	response.hwpid = data[4] | ((uint16_t) data[5] << 8);
+	response.errorCode = data[6];
+	response.dpaValue = data[7];
+	response.data = &data[dpaConstants::RESPONSE_HEADER_LENGTH];
+	response.dataLength = dataLength - dpaConstants::RESPONSE_HEADER_LENGTH;
+	dpaRequest_t *request = this->find(response.nadr, response.pnum, response.pcmd & ~dpaConstants::RESPONSE_FLAG);
+	if (request == NULL) {
+		// asynchronous packet or late response
+		return false;
+	}
+	if (response.errorCode == dpaConstants::STATUS_CONFIRMATION) {
+		if (response.dataLength >= 3) {
+			// PData of confirmation: hops, timeslot length in 10 ms, hops of response
+			unsigned long routingMs = ((unsigned long) response.data[0] + 1 + response.data[2] + 1) * response.data[1] * 10;
+			request->timeout += routingMs;
+		}
+		if (response.nadr == dpaConstants::BROADCAST_ADDRESS) {
+			// broadcast has no response, confirmation finishes it
+			this->complete(request, results::BROADCAST_DONE, &response);
+			return true;
+		}
+		request->startMs = millis();
+		if (request->handler != NULL) {
+			request->handler(request->requestId, results::CONFIRMATION, &response);
+		}
+		return true;
+	}
+	this->complete(request, results::RESPONSE, &response);
+	return true;
+}
+
+/**
+ * Process result of Tx packet, it must be called from Tx callback of the application
+ * @param packetId Packet ID
+ * @param packetResult Packet writing result
+ * @return Packet was a DPA request
+ */
+bool IQRFDpa::txDone(uint8_t packetId, uint8_t packetResult) {
+	for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+		dpaRequest_t *request = &this->requests[i];
+		if (request->requestId && request->packetId == packetId) {
+			request->packetId = 0;
+			if (packetResult != IQRFPackets::statuses::OK) {
+				this->complete(request, results::TX_ERROR, NULL);
+			} else {
+				request->startMs = millis();
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Periodically called task, it completes requests without response in time
+ */
+void IQRFDpa::task() {
+	unsigned long nowMs = millis();
+	for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+		dpaRequest_t *request = &this->requests[i];
+		// timeout does not elapse while the request waits in Tx queue
+		if (request->requestId && !request->packetId && nowMs - request->startMs >= request->timeout) {
+			this->timeoutCounter++;
+			this->complete(request, results::TIMEOUT, NULL);
+		}
+	}
+}
+
+/**
+ * Get count of outstanding requests
+ * @return Count of outstanding requests
+ */
+uint8_t IQRFDpa::getPendingCount() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+		if (this->requests[i].requestId) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Get count of requests without response in time
+ * @return Count of timed out requests
+ */
+unsigned long IQRFDpa::getTimeoutCount() {
+	return this->timeoutCounter;
+}
+
+/**
+ * Find outstanding request
+ * @param nadr Network address
+ * @param pnum Peripheral number
+ * @param pcmd Peripheral command without response flag
+ * @return Outstanding request or NULL
+ */
+IQRFDpa::dpaRequest_t* IQRFDpa::find(uint16_t nadr, uint8_t pnum, uint8_t pcmd) {
+	for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+		dpaRequest_t *request = &this->requests[i];
+		if (request->requestId && request->nadr == nadr && request->pnum == pnum && request->pcmd == pcmd) {
+			return request;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Find free slot of outstanding request
+ * @return Free slot or NULL if DPA_REQUESTS requests are outstanding
+ */
+IQRFDpa::dpaRequest_t* IQRFDpa::findFree() {
+	for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+		if (!this->requests[i].requestId) {
+			return &this->requests[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Get next request ID which is not used by an outstanding request
+ * @return Request ID (number 1-255)
+ */
+uint8_t IQRFDpa::newRequestId() {
+	bool used;
+	do {
+		this->lastRequestId = (this->lastRequestId == 255) ? 1 : this->lastRequestId + 1;
+		used = false;
+		for (uint8_t i = 0; i < DPA_REQUESTS; i++) {
+			used |= (this->requests[i].requestId == this->lastRequestId);
+		}
+	} while (used);
+	return this->lastRequestId;
+}
+
+/**
+ * Free slot of the request and call its completion handler
+ * @param request Outstanding request
+ * @param result Result (see IQRFDpa::results)
+ * @param response Response or NULL
+ */
+void IQRFDpa::complete(dpaRequest_t *request, uint8_t result, const dpaResponse_t *response) {
+	uint8_t requestId = request->requestId;
+	handler_t handler = request->handler;
+	// handler can send next request to the same slot
+	request->requestId = 0;
+	if (handler != NULL) {
+		handler(requestId, result, response);
+	}
+}
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFDPA_H
+#define IQRFDPA_H
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stdint.h>
+
+#include "IQRFBase.h"
+#include "IQRFSettings.h"
+
+/**
+ * DPA response or confirmation
+ */
+typedef struct {
+	uint16_t nadr; //!< Network address
+	uint8_t pnum; //!< Peripheral number
+	uint8_t pcmd; //!< Peripheral command
+	uint16_t hwpid; //!< Hardware profile ID
+	uint8_t errorCode; //!< Response code
+	uint8_t dpaValue; //!< DPA value
+	const uint8_t *data; //!< Pointer to PData, valid in the handler only
+	uint8_t dataLength; //!< Length of PData
+} dpaResponse_t;
+
+/**
+ * DPA request/response layer
+ * Requests are framed in one frame buffer and queued as Tx packets, responses and confirmations
+ * are matched to outstanding requests by NADR, PNUM and PCMD
+ */
+class IQRFDpa {
+public:
+	/// Completion handler of DPA request, response is NULL if no frame was received
+	typedef void (*handler_t)(uint8_t requestId, uint8_t result, const dpaResponse_t *response);
+	void begin(IQRFBase *iqrf);
+	uint8_t send(uint16_t nadr, uint8_t pnum, uint8_t pcmd, uint16_t hwpid, const uint8_t *data, uint8_t dataLength, handler_t handler, unsigned long timeout = DPA_TIMEOUT);
+	bool rxDone(const uint8_t *data, uint8_t dataLength);
+	bool txDone(uint8_t packetId, uint8_t packetResult);
+	void task();
+	uint8_t getPendingCount();
+	unsigned long getTimeoutCount();
+
+	/**
+	 * Results passed to completion handler
+	 */
+	enum results {
+		RESPONSE = 0, //!< Response was received, see its errorCode
+		CONFIRMATION = 1, //!< Coordinator confirmed the request, response follows
+		TX_ERROR = 2, //!< Request was not sent to TR module
+		TIMEOUT = 3, //!< Response was not received in time
+		BROADCAST_DONE = 4 //!< Coordinator confirmed the broadcast, no response follows
+	};
+
+	/**
+	 * Special DPA values
+	 */
+	enum dpaConstants {
+		HEADER_LENGTH = 6, //!< Length of request header (NADR, PNUM, PCMD, HWPID)
+		RESPONSE_HEADER_LENGTH = 8, //!< Length of response header (NADR, PNUM, PCMD, HWPID, ErrN, DpaValue)
+		RESPONSE_FLAG = 0x80, //!< PCMD flag of responses
+		STATUS_CONFIRMATION = 0xFF, //!< Response code of confirmation
+		COORDINATOR_ADDRESS = 0x0000, //!< NADR of coordinator
+		BROADCAST_ADDRESS = 0xFFFF //!< NADR of broadcast
+	};
+private:
+	/**
+	 * Outstanding DPA request
+	 */
+	typedef struct {
+		uint8_t requestId; //!< Request ID, 0 for free slot
+		uint8_t packetId; //!< ID of Tx packet, 0 after the packet was sent
+		uint16_t nadr; //!< Network address
+		uint8_t pnum; //!< Peripheral number
+		uint8_t pcmd; //!< Peripheral command
+		handler_t handler; //!< Completion handler
+		unsigned long startMs; //!< Start of timeout in ms
+		unsigned long timeout; //!< Timeout in ms
+	} dpaRequest_t;
+	dpaRequest_t* find(uint16_t nadr, uint8_t pnum, uint8_t pcmd);
+	dpaRequest_t* findFree();
+	uint8_t newRequestId();
+	void complete(dpaRequest_t *request, uint8_t result, const dpaResponse_t *response);
+	/// IQRF driver
+	IQRFBase *iqrf;
+	/// Outstanding requests
+	dpaRequest_t requests[DPA_REQUESTS];
+	/// Last assigned request ID
+	uint8_t lastRequestId;
+	/// Frame of sent request
+	uint8_t frame[PACKET_SIZE - 4];
+	/// Count of requests without response in time
+	unsigned long timeoutCounter;
+	/// Request is passed to Tx queue, send() is not reentrant
+	bool sending = false;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFDRIVER_H
+#define IQRFDRIVER_H
+
+#include <stdint.h>
+
+#include "CallbackFunctions.h"
+#include "IQRFBase.h"
+
+/**
+ * Storage of IQRF SPI driver, sizes of buffers are fixed at compile time
+ * @tparam QueueDepth Count of packets in Tx queue
+ * @tparam ArenaSize Size of Tx queue data arena, it limits data waiting in Tx queue
+ * @tparam RxFrames Count of Rx frames (2 = double buffering)
+ * @tparam HighQueueDepth Count of packets in high priority Tx queue
+ * @tparam HighArenaSize Size of high priority Tx queue data arena
+ */
+template <uint8_t QueueDepth, uint16_t ArenaSize, uint8_t RxFrames = RX_FRAME_COUNT,
+	uint8_t HighQueueDepth = PACKET_BUFFER_HIGH_SIZE, uint16_t HighArenaSize = PACKET_ARENA_HIGH_SIZE>
+class IQRFStorage {
+	static_assert(QueueDepth > 0 && HighQueueDepth > 0, "Tx queue must have at least one slot");
+	static_assert(ArenaSize >= PACKET_SIZE - 4 && HighArenaSize >= PACKET_SIZE - 4, "Tx arena must fit the largest packet");
+	static_assert(RxFrames > 0, "At least one Rx frame is required");
+public:
+	/**
+	 * Use the storage in driver, must be called before driver initialization
+	 * @param txQueue Tx queue of driver
+	 * @param txQueueHigh High priority Tx queue of driver
+	 * @param buffers SPI buffers of driver
+	 */
+	void attach(IQRFTxQueue &txQueue, IQRFTxQueue &txQueueHigh, IQRFBuffers &buffers) {
+		txQueue.begin(this->txPacketBuffer, QueueDepth, this->txPacketArena, ArenaSize);
+		txQueueHigh.begin(this->txPacketBufferHigh, HighQueueDepth, this->txPacketArenaHigh, HighArenaSize);
+		buffers.begin(this->rxFrames, this->rxQueue, RxFrames);
+	}
+private:
+	/// Tx packet buffer
+	packetBuffer_t txPacketBuffer[QueueDepth];
+	/// Tx packet data arena
+	uint8_t txPacketArena[ArenaSize];
+	/// High priority Tx packet buffer
+	packetBuffer_t txPacketBufferHigh[HighQueueDepth];
+	/// High priority Tx packet data arena
+	uint8_t txPacketArenaHigh[HighArenaSize];
+	/// Rx frames
+	rxFrame_t rxFrames[RxFrames];
+	/// Rx queue of frame indexes
+	uint8_t rxQueue[RxFrames];
+};
+
+/**
+ * IQRF driver with buffers sized at compile time, e.g. IQRFDriver<4, 64, 1> for boards with small SRAM
+ * Driver code is shared by all sizes, only the storage is instantiated
+ * Plain IQRF is IQRFDriver sized by IQRFSettings.h
+ * @tparam QueueDepth Count of packets in Tx queue
+ * @tparam ArenaSize Size of Tx queue data arena, it limits data waiting in Tx queue
+ * @tparam RxFrames Count of Rx frames (2 = double buffering)
+ * @tparam HighQueueDepth Count of packets in high priority Tx queue
+ * @tparam HighArenaSize Size of high priority Tx queue data arena
+ */
+template <uint8_t QueueDepth, uint16_t ArenaSize, uint8_t RxFrames = RX_FRAME_COUNT,
+	uint8_t HighQueueDepth = PACKET_BUFFER_HIGH_SIZE, uint16_t HighArenaSize = PACKET_ARENA_HIGH_SIZE>
+class IQRFDriver : public IQRFBase {
+public:
+	/**
+	 * Function perform a TR-module driver initialization
+	 * @param rxCallback Pointer to callback function. Function is called when the driver receives data from the TR module
+	 * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
+	 */
+	void begin(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback) {
+		this->storage.attach(this->txQueue, this->txQueueHigh, this->buffers);
+		this->init(rxCallback, NULL, txCallback);
+	}
+
+	/**
+	 * Function perform a TR-module driver initialization
+	 * Received data are passed to Rx callback without copying, see releaseData()
+	 * @param rxCallback Pointer to callback function. Function is called with read-only view of data received from the TR module
+	 * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
+	 */
+	void begin(IQRFCallbacks::rxViewCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback) {
+		this->storage.attach(this->txQueue, this->txQueueHigh, this->buffers);
+		this->init(doNothingRx, rxCallback, txCallback);
+	}
+
+	/**
+	 * Function starts a TR-module driver initialization and returns immediately
+	 * TR module info is read in following driver() calls, see isReady()
+	 * @param rxCallback Pointer to callback function. Function is called when the driver receives data from the TR module
+	 * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
+	 * @param readyCallback Pointer to callback function or NULL. Function is called when the driver is ready
+	 */
+	void beginAsync(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback, IQRFCallbacks::readyCallback_t readyCallback = NULL) {
+		this->storage.attach(this->txQueue, this->txQueueHigh, this->buffers);
+		this->start(rxCallback, NULL, txCallback, readyCallback);
+	}
+
+	/**
+	 * Function starts a TR-module driver initialization and returns immediately
+	 * Received data are passed to Rx callback without copying, see releaseData()
+	 * @param rxCallback Pointer to callback function. Function is called with read-only view of data received from the TR module
+	 * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
+	 * @param readyCallback Pointer to callback function or NULL. Function is called when the driver is ready
+	 */
+	void beginAsync(IQRFCallbacks::rxViewCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback, IQRFCallbacks::readyCallback_t readyCallback = NULL) {
+		this->storage.attach(this->txQueue, this->txQueueHigh, this->buffers);
+		this->start(doNothingRx, rxCallback, txCallback, readyCallback);
+	}
+private:
+	/// Driver storage
+	IQRFStorage<QueueDepth, ArenaSize, RxFrames, HighQueueDepth, HighArenaSize> storage;
+};
+
+#endif
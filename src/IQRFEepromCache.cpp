@@ -0,0 +1,97 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFEepromCache.h"
+
+#if defined(IQRF_EEPROM_CACHE)
+
+#include <EEPROM.h>
+
+/// Signature of valid record
+const uint8_t cacheSignature[2] = {'I', 'Q'};
+
+/**
+ * Set address of the record in EEPROM, it must be set before driver initialization
+ * @param address Address of 11 B record in EEPROM
+ */
+void IQRFEepromCache::setAddress(uint16_t address) {
+	this->address = address;
+}
+
+/**
+ * Get address of the record in EEPROM
+ * @return Address of the record in EEPROM
+ */
+uint16_t IQRFEepromCache::getAddress() {
+	return this->address;
+}
+
+/**
+ * Load cached identification data from EEPROM
+ * @param data Buffer for 8 B of identification data
+ * @return Valid identification data were loaded
+ */
+bool IQRFEepromCache::load(uint8_t *data) {
+	if (EEPROM.read(this->address) != cacheSignature[0] || EEPROM.read(this->address + 1) != cacheSignature[1]) {
+		return false;
+	}
+	uint8_t checksum = 0x5F;
+	for (uint8_t i = 0; i < 8; i++) {
+		data[i] = EEPROM.read(this->address + 2 + i);
+		checksum ^= data[i];
+	}
+	return EEPROM.read(this->address + 10) == checksum;
+}
+
+/**
+ * Save identification data to EEPROM, unchanged bytes are not written
+ * @param data 8 B of identification data
+ */
+void IQRFEepromCache::save(const uint8_t *data) {
+	uint8_t checksum = 0x5F;
+	for (uint8_t i = 0; i < 8; i++) {
+		this->update(this->address + 2 + i, data[i]);
+		checksum ^= data[i];
+	}
+	this->update(this->address + 10, checksum);
+	this->update(this->address, cacheSignature[0]);
+	this->update(this->address + 1, cacheSignature[1]);
+}
+
+/**
+ * Invalidate the record, identification data are read in programming mode on next boot
+ */
+void IQRFEepromCache::clear() {
+	this->update(this->address, 0xFF);
+}
+
+/**
+ * Write byte to EEPROM only if it differs, it saves EEPROM write cycles
+ * @param address Address in EEPROM
+ * @param value Written byte
+ */
+void IQRFEepromCache::update(uint16_t address, uint8_t value) {
+	if (EEPROM.read(address) != value) {
+		EEPROM.write(address, value);
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFEEPROMCACHE_H
+#define IQRFEEPROMCACHE_H
+
+#include <stdint.h>
+
+#include "IQRFInfoCache.h"
+#include "IQRFSettings.h"
+
+#if defined(IQRF_EEPROM_CACHE)
+
+/**
+ * Cache of TR module identification data in EEPROM of MCU
+ * Record has 11 B: 2 B signature, 8 B identification data and 1 B checksum
+ */
+class IQRFEepromCache : public IQRFInfoCache {
+public:
+	void setAddress(uint16_t address);
+	uint16_t getAddress();
+	bool load(uint8_t *data);
+	void save(const uint8_t *data);
+	void clear();
+private:
+	void update(uint16_t address, uint8_t value);
+	/// Address of the record in EEPROM
+	uint16_t address = IQRF_CACHE_ADDRESS;
+};
+
+#endif
+
+#endif
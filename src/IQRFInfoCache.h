@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFINFOCACHE_H
+#define IQRFINFOCACHE_H
+
+#include <stdint.h>
+
+#include "IQRFSettings.h"
+
+/**
+ * Persistent cache of TR module identification data
+ * Cached identity is verified by module ID read in communication mode,
+ * so the driver does not switch TR module to programming mode on warm boot
+ * Storage backend implements load() and save(), see IQRFEepromCache
+ */
+class IQRFInfoCache {
+public:
+	/**
+	 * Load cached identification data
+	 * @param data Buffer for 8 B of identification data
+	 * @return Valid identification data were loaded
+	 */
+	virtual bool load(uint8_t *data) = 0;
+
+	/**
+	 * Save identification data read in programming mode
+	 * @param data 8 B of identification data
+	 */
+	virtual void save(const uint8_t *data) = 0;
+};
+
+#endif
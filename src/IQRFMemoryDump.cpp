@@ -0,0 +1,174 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFMemoryDump.h"
+
+/**
+ * Start memory dump, TR module must be in debug mode
+ * Tx callback of the application must pass results of Tx packets to txDone()
+ * @param iqrf IQRF driver, it must be ready
+ * @param spiCmd SPI command of read packets (IQRFSPI::commands::RAM_READ or IQRFSPI::commands::EEPROM_READ)
+ * @param address Address of the first read byte
+ * @param length Count of read bytes
+ * @param sink Sink of read chunks, it is called from Tx callback with address of each chunk
+ * @return Dump was started
+ */
+bool IQRFMemoryDump::begin(IQRFBase *iqrf, uint8_t spiCmd, uint16_t address, uint16_t length, sink_t sink) {
+	if (this->task() || !iqrf->isReady() || iqrf->getSpiStatus() != IQRFSPI::statuses::DEBUG_MODE || length == 0 ||
+		(spiCmd != IQRFSPI::commands::RAM_READ && spiCmd != IQRFSPI::commands::EEPROM_READ)) {
+		return false;
+	}
+	this->iqrf = iqrf;
+	this->spiCmd = spiCmd;
+	this->nextAddress = address;
+	this->remaining = length;
+	this->sink = sink;
+	this->windowCount = 0;
+	this->byteCount = 0;
+	memset(this->request, 0, sizeof(this->request));
+	this->startMs = millis();
+	this->status = statuses::READ;
+	return true;
+}
+
+/**
+ * Periodically called dump task, it must be called together with driver
+ * Next read packets are queued while previous ones are transferred, at most DUMP_WINDOW at once
+ * @return Dump is in progress
+ */
+bool IQRFMemoryDump::task() {
+	if (this->status == statuses::READ) {
+		while (this->remaining && this->sendRequest());
+		if (!this->remaining && this->windowCount == 0) {
+			this->endMs = millis();
+			this->status = statuses::DONE;
+		}
+	}
+	return this->status == statuses::READ;
+}
+
+/**
+ * Process result of Tx packet, it must be called from Tx callback of the application
+ * Read data are returned by TR module in the same SPI packet in place of zeros following the address,
+ * the packet is found in the window by its ID, so it is passed to the sink with its own address
+ * @param packetId Packet ID
+ * @param packetResult Packet writing result
+ * @return Packet was sent by the dump
+ */
+bool IQRFMemoryDump::txDone(uint8_t packetId, uint8_t packetResult) {
+	uint8_t i = 0;
+	while (i < this->windowCount && this->window[i] != packetId) {
+		i++;
+	}
+	if (i == this->windowCount) {
+		return false;
+	}
+	if (this->status == statuses::READ) {
+		if (packetResult == IQRFPackets::statuses::OK) {
+			uint8_t data[PACKET_SIZE - 4];
+			this->iqrf->getData(data, this->windowLength[i] + 2);
+			this->byteCount += this->windowLength[i];
+			this->sink(this->windowAddress[i], &data[2], this->windowLength[i]);
+		} else {
+			// other packets in the window are ignored, the range has a gap
+			this->endMs = millis();
+			this->status = statuses::FAILED;
+		}
+	}
+	this->windowCount--;
+	for (; i < this->windowCount; i++) {
+		this->window[i] = this->window[i + 1];
+		this->windowAddress[i] = this->windowAddress[i + 1];
+		this->windowLength[i] = this->windowLength[i + 1];
+	}
+	return true;
+}
+
+/**
+ * Set data length of one read packet, it must be set before begin()
+ * @param size Data length of one read packet (1-62)
+ */
+void IQRFMemoryDump::setChunkSize(uint8_t size) {
+	if (size == 0 || size > sizeof(this->request) - 2) {
+		size = sizeof(this->request) - 2;
+	}
+	this->chunkSize = size;
+}
+
+/**
+ * Get dump status
+ * @return Dump status (see IQRFMemoryDump::statuses)
+ */
+uint8_t IQRFMemoryDump::getStatus() {
+	return this->status;
+}
+
+/**
+ * Get count of bytes passed to the sink
+ * @return Count of read bytes
+ */
+unsigned long IQRFMemoryDump::getByteCount() {
+	return this->byteCount;
+}
+
+/**
+ * Get dump speed
+ * @return Read bytes per second
+ */
+unsigned long IQRFMemoryDump::getBytesPerSecond() {
+	if (this->status == statuses::IDLE) {
+		return 0;
+	}
+	unsigned long elapsedMs = ((this->status == statuses::READ) ? millis() : this->endMs) - this->startMs;
+	return elapsedMs ? (this->byteCount * 1000) / elapsedMs : 0;
+}
+
+/**
+ * Get retry policy of read packets
+ * @return Retry policy of read packets
+ */
+IQRFRetryPolicy& IQRFMemoryDump::getRetryPolicy() {
+	return this->retryPolicy;
+}
+
+/**
+ * Send next read packet to Tx queue
+ * @return Packet was queued, otherwise the window or Tx queue is full
+ */
+bool IQRFMemoryDump::sendRequest() {
+	uint8_t length = (this->remaining < this->chunkSize) ? this->remaining : this->chunkSize;
+	if (this->windowCount == DUMP_WINDOW || !this->iqrf->canSendData(length + 2)) {
+		return false;
+	}
+	this->request[0] = this->nextAddress & 0xFF;
+	this->request[1] = this->nextAddress >> 8;
+	uint8_t packetId = this->iqrf->sendSpiPacket(this->spiCmd, this->request, length + 2, 0, IQRFPackets::priorities::NORMAL_PRIORITY, &this->retryPolicy);
+	if (!packetId) {
+		return false;
+	}
+	this->window[this->windowCount] = packetId;
+	this->windowAddress[this->windowCount] = this->nextAddress;
+	this->windowLength[this->windowCount] = length;
+	this->windowCount++;
+	this->nextAddress += length;
+	this->remaining -= length;
+	return true;
+}
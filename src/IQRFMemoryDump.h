@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFMEMORYDUMP_H
+#define IQRFMEMORYDUMP_H
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stdint.h>
+
+#include "IQRFBase.h"
+#include "IQRFRetryPolicy.h"
+#include "IQRFSettings.h"
+
+/**
+ * Memory dump of TR module in debug mode
+ * Address range is read by pipelined RAM_READ or EEPROM_READ packets,
+ * read chunks are passed to a sink with their address when their packets are finished,
+ * it is address order while packets are finished in the order they were queued
+ */
+class IQRFMemoryDump {
+public:
+	/// Sink of read memory chunks
+	typedef void (*sink_t)(uint16_t address, const uint8_t *data, uint8_t dataLength);
+	bool begin(IQRFBase *iqrf, uint8_t spiCmd, uint16_t address, uint16_t length, sink_t sink);
+	bool task();
+	bool txDone(uint8_t packetId, uint8_t packetResult);
+	void setChunkSize(uint8_t size);
+	uint8_t getStatus();
+	unsigned long getByteCount();
+	unsigned long getBytesPerSecond();
+	IQRFRetryPolicy& getRetryPolicy();
+
+	/**
+	 * Memory dump statuses
+	 */
+	enum statuses {
+		IDLE = 0, //!< Dump was not started
+		READ = 1, //!< Read packets are sent
+		DONE = 2, //!< Whole address range was read
+		FAILED = 3 //!< TR module did not accept a read packet
+	};
+private:
+	bool sendRequest();
+	/// IQRF driver
+	IQRFBase *iqrf;
+	/// Sink of read chunks
+	sink_t sink;
+	/// Retry policy of read packets
+	IQRFRetryPolicy retryPolicy;
+	/// SPI command of read packets (RAM_READ or EEPROM_READ)
+	uint8_t spiCmd;
+	/// Dump status
+	uint8_t status = statuses::IDLE;
+	/// Data length of one read packet
+	uint8_t chunkSize = DUMP_CHUNK_SIZE;
+	/// Address of next read packet
+	uint16_t nextAddress;
+	/// Count of bytes which were not requested yet
+	uint16_t remaining;
+	/// IDs of sent packets which were not finished yet
+	uint8_t window[DUMP_WINDOW];
+	/// Addresses of sent packets which were not finished yet
+	uint16_t windowAddress[DUMP_WINDOW];
+	/// Data lengths of sent packets which were not finished yet
+	uint8_t windowLength[DUMP_WINDOW];
+	/// Count of packets in the window
+	uint8_t windowCount;
+	/// Packet data, address and zeros in place of read data
+	uint8_t request[PACKET_SIZE - 4];
+	/// Count of read bytes
+	unsigned long byteCount;
+	/// Start of dump in ms
+	unsigned long startMs;
+	/// End of dump in ms
+	unsigned long endMs;
+};
+
+#endif
@@ -25,14 +25,13 @@
 #include <stdint.h>
 
 #include "IQRFSettings.h"
-#include "iqrf_library.h"
 
 /**
  * IQRF Packets
  */
 class IQRFPackets {
 public:
-	uint8_t send(uint8_t spiCmd, uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag);
+	uint8_t newId();
 	void setId(uint8_t id);
 	uint8_t getId();
 	void setIdCount(uint8_t count);
@@ -45,7 +44,17 @@ public:
 	 */
 	enum statuses {
 		OK = 1, //!< Packet sent OK
-		ERROR = 2 //!< Packet sent with ERROR
+		ERROR = 2, //!< Packet sent with ERROR
+		DROPPED = 3, //!< Packet dropped from full Tx queue
+		EXPIRED = 4 //!< Packet deadline elapsed before the packet was sent
+	};
+
+	/**
+	 * Tx packet priorities
+	 */
+	enum priorities {
+		NORMAL_PRIORITY = 0, //!< Bulk data
+		HIGH_PRIORITY = 1 //!< Control packets, sent before packets with normal priority
 	};
 private:
 	/// Actual Tx packet ID
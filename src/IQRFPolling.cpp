@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFPolling.h"
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+/**
+ * Initialize status polling with default intervals
+ */
+void IQRFPolling::begin() {
+	this->setIntervals(POLL_MIN_INTERVAL, POLL_MAX_INTERVAL);
+	this->pollNowFlag = false;
+	this->dataReadyFlag = false;
+	this->polledReadyFlag = false;
+	this->resetCounters();
+}
+
+/**
+ * Set status polling intervals
+ * Status is polled every minUs after traffic, interval is doubled on each idle poll up to maxUs
+ * @param minUs Minimal status polling interval in us
+ * @param maxUs Maximal status polling interval in us
+ */
+void IQRFPolling::setIntervals(unsigned long minUs, unsigned long maxUs) {
+	if (maxUs < minUs) {
+		maxUs = minUs;
+	}
+	this->minInterval = minUs;
+	this->maxInterval = maxUs;
+	this->interval = minUs;
+}
+
+/**
+ * Get minimal status polling interval
+ * @return Minimal status polling interval in us
+ */
+unsigned long IQRFPolling::getMinInterval() {
+	return this->minInterval;
+}
+
+/**
+ * Get maximal status polling interval
+ * @return Maximal status polling interval in us
+ */
+unsigned long IQRFPolling::getMaxInterval() {
+	return this->maxInterval;
+}
+
+/**
+ * Get actual status polling interval
+ * @return Actual status polling interval in us
+ */
+unsigned long IQRFPolling::getInterval() {
+	return this->interval;
+}
+
+/**
+ * Check if status poll is due
+ * @param elapsedUs Time from last SPI activity in us
+ * @return Status poll is due
+ */
+bool IQRFPolling::isDue(unsigned long elapsedUs) {
+	if (this->pollNowFlag || this->dataReadyFlag) {
+		return true;
+	}
+	return elapsedUs > this->interval;
+}
+
+/**
+ * Status poll is sent to TR module, it must be called before the status is read
+ * Data ready signal is taken by this poll, signal from interrupt after this call is kept for next poll
+ */
+void IQRFPolling::polled() {
+	this->pollCounter++;
+	this->pollNowFlag = false;
+	// multi-byte time must not be changed by interrupt while it is read
+	noInterrupts();
+	this->polledReadyFlag = this->dataReadyFlag;
+	this->polledReadyUs = this->dataReadyUs;
+	this->dataReadyFlag = false;
+	interrupts();
+}
+
+/**
+ * SPI traffic occurred, poll status again after minimal interval
+ */
+void IQRFPolling::traffic() {
+	this->interval = this->minInterval;
+}
+
+/**
+ * Poll status in next driver call without waiting for interval
+ */
+void IQRFPolling::pollNow() {
+	this->traffic();
+	this->pollNowFlag = true;
+}
+
+/**
+ * Status poll found nothing to do, back off up to maximal interval
+ */
+void IQRFPolling::idle() {
+	if (this->interval < this->maxInterval / 2) {
+		this->interval *= 2;
+	} else {
+		this->interval = this->maxInterval;
+	}
+	if (this->interval == 0) {
+		this->interval = 1;
+	}
+}
+
+/**
+ * Data ready signal, it can be called from external interrupt (GPIO edge) handler
+ */
+void IQRFPolling::dataReady() {
+	this->dataReadyUs = micros();
+	this->dataReadyFlag = true;
+}
+
+/**
+ * Status poll found data ready in TR module, update notice latency counters
+ * Without data ready signal the latency is the time from previous poll (worst case)
+ * @param nowUs Time of status poll in us
+ * @param elapsedUs Time from previous SPI activity in us
+ */
+void IQRFPolling::noticed(unsigned long nowUs, unsigned long elapsedUs) {
+	unsigned long latencyUs = elapsedUs;
+	if (this->polledReadyFlag) {
+		latencyUs = nowUs - this->polledReadyUs;
+	}
+	this->noticeCounter++;
+	this->noticeLatencySum += latencyUs;
+	if (latencyUs > this->noticeLatencyMax) {
+		this->noticeLatencyMax = latencyUs;
+	}
+	this->traffic();
+}
+
+/**
+ * Get count of status polls
+ * @return Count of status polls
+ */
+unsigned long IQRFPolling::getPollCount() {
+	return this->pollCounter;
+}
+
+/**
+ * Get count of status polls which found data ready in TR module
+ * @return Count of noticed data ready statuses
+ */
+unsigned long IQRFPolling::getNoticeCount() {
+	return this->noticeCounter;
+}
+
+/**
+ * Get average latency between data ready in TR module and its notice by status poll
+ * Without data ready signal (GPIO hook) time from previous SPI activity is counted,
+ * so the value is only an upper bound of the real latency
+ * @return Average notice latency in us
+ */
+unsigned long IQRFPolling::getAverageNoticeLatency() {
+	if (this->noticeCounter == 0) {
+		return 0;
+	}
+	return this->noticeLatencySum / this->noticeCounter;
+}
+
+/**
+ * Get maximal latency between data ready in TR module and its notice by status poll
+ * Without data ready signal (GPIO hook) it is only an upper bound of the real latency
+ * @return Maximal notice latency in us
+ */
+unsigned long IQRFPolling::getMaxNoticeLatency() {
+	return this->noticeLatencyMax;
+}
+
+/**
+ * Reset status polling counters
+ */
+void IQRFPolling::resetCounters() {
+	this->pollCounter = 0;
+	this->noticeCounter = 0;
+	this->noticeLatencySum = 0;
+	this->noticeLatencyMax = 0;
+}
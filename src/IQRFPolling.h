@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFPOLLING_H
+#define IQRFPOLLING_H
+
+#include <stdint.h>
+
+#include "IQRFSettings.h"
+
+/**
+ * Adaptive SPI status polling
+ */
+class IQRFPolling {
+public:
+	void begin();
+	void setIntervals(unsigned long minUs, unsigned long maxUs);
+	unsigned long getMinInterval();
+	unsigned long getMaxInterval();
+	unsigned long getInterval();
+	bool isDue(unsigned long elapsedUs);
+	void polled();
+	void traffic();
+	void pollNow();
+	void idle();
+	void dataReady();
+	void noticed(unsigned long nowUs, unsigned long elapsedUs);
+	unsigned long getPollCount();
+	unsigned long getNoticeCount();
+	unsigned long getAverageNoticeLatency();
+	unsigned long getMaxNoticeLatency();
+	void resetCounters();
+private:
+	/// Minimal status polling interval in us
+	unsigned long minInterval;
+	/// Maximal status polling interval in us
+	unsigned long maxInterval;
+	/// Actual status polling interval in us
+	unsigned long interval;
+	/// Status poll requested without waiting for interval
+	bool pollNowFlag;
+	/// Data ready signaled by external interrupt
+	volatile bool dataReadyFlag;
+	/// Time of data ready signal in us
+	volatile unsigned long dataReadyUs;
+	/// Data ready was signaled before last status poll
+	bool polledReadyFlag;
+	/// Time of data ready signal taken by last status poll in us
+	unsigned long polledReadyUs;
+	/// Count of status polls
+	unsigned long pollCounter;
+	/// Count of noticed data ready statuses
+	unsigned long noticeCounter;
+	/// Sum of notice latencies in us
+	unsigned long noticeLatencySum;
+	/// Maximal notice latency in us
+	unsigned long noticeLatencyMax;
+};
+
+#endif
@@ -0,0 +1,599 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFProgrammer.h"
+
+/**
+ * Start programming of TR module, TR module is switched to programming mode
+ * Tx callback of the application must pass results of Tx packets to txDone()
+ * @param iqrf IQRF driver, it must be ready
+ * @param stream Stream with the image (Serial, file on SD card, ...)
+ * @param format Format of the image (see IQRFProgrammer::formats)
+ * @return Programming was started
+ */
+bool IQRFProgrammer::begin(IQRFBase *iqrf, Stream *stream, uint8_t format) {
+	if (!iqrf->isReady() || this->task()) {
+		return false;
+	}
+	this->iqrf = iqrf;
+	this->stream = stream;
+	this->format = format;
+	// TR module does not accept packets while it writes flash
+	this->retryPolicy.setMaxAttempts(PGM_ATTEMPTS);
+	this->error = errors::NO_ERROR;
+	this->lineNumber = 1;
+	this->comment = false;
+	this->nibble = false;
+	this->recordIndex = -1;
+	this->recordPending = false;
+	this->baseAddress = 0;
+	this->blockLength = 0;
+	this->blockReady = false;
+	this->blockVerified = false;
+	this->blockWritten = false;
+	this->readBackStatus = readBackStatuses::READ_BACK_UNVERIFIED;
+	this->readPacketId = 0;
+	this->readCount = 0;
+	this->windowCount = 0;
+	this->endPacketId = 0;
+	this->byteCount = 0;
+	this->packetCount = 0;
+	this->skippedBlockCount = 0;
+	this->iqrf->getTr().enterProgramMode();
+	this->beginMs = millis();
+	this->activityMs = this->beginMs;
+	this->status = statuses::ENTER_PGM;
+	return true;
+}
+
+/**
+ * Periodically called programming task, it must be called together with driver
+ * Image is parsed until the block of the next packet is complete,
+ * at most PGM_WINDOW packets are in Tx queue and in transfer
+ * @return Programming is in progress
+ */
+bool IQRFProgrammer::task() {
+	switch (this->status) {
+		case statuses::ENTER_PGM:
+			if (this->iqrf->isResetting() || this->iqrf->getTr().getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_VERIFY) {
+				// timeout starts when TR module is reset and in programming mode
+				this->activityMs = millis();
+			} else if (this->iqrf->getSpiStatus() == IQRFSPI::statuses::PROGRAMMING_MODE) {
+				this->startMs = millis();
+				this->activityMs = this->startMs;
+				this->status = statuses::UPLOAD;
+			} else if (millis() - this->activityMs >= PGM_TIMEOUT ||
+				this->iqrf->getTr().getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_FAILED) {
+				this->error = errors::MODE_ERROR;
+				this->doneMs = millis();
+				this->status = statuses::FAILED;
+			}
+			break;
+		case statuses::UPLOAD:
+		case statuses::FLUSH:
+			while (true) {
+				if (this->blockReady) {
+					if (!this->sendBlock()) {
+						break;
+					}
+				} else if (this->recordPending) {
+					this->placeRecord();
+				} else if (this->status != statuses::UPLOAD) {
+					break;
+				} else if (this->stream->available() > 0) {
+					this->parse(this->stream->read());
+					this->activityMs = millis();
+				} else {
+					if (millis() - this->activityMs >= PGM_TIMEOUT) {
+						if (this->format == formats::HEX_FORMAT) {
+							// Intel HEX image ends by end of file record
+							this->fail(errors::STREAM_ERROR);
+						} else {
+							// plugin ends by end of stream
+							this->parse('\n');
+							this->status = statuses::FLUSH;
+						}
+					}
+					break;
+				}
+			}
+			if (this->status == statuses::FLUSH && !this->blockReady && !this->readPacketId && this->windowCount == 0) {
+				this->endPacketId = this->iqrf->endProgramMode();
+				if (this->endPacketId) {
+					this->endMs = millis();
+					this->status = statuses::END_PGM;
+				}
+			}
+			break;
+	}
+	return this->status != statuses::IDLE && this->status != statuses::DONE && this->status != statuses::FAILED;
+}
+
+/**
+ * Process result of Tx packet, it must be called from Tx callback of the application
+ * @param packetId Packet ID
+ * @param packetResult Packet writing result
+ * @return Packet was sent by the programmer
+ */
+bool IQRFProgrammer::txDone(uint8_t packetId, uint8_t packetResult) {
+	if (this->status == statuses::END_PGM && packetId == this->endPacketId) {
+		if (packetResult != IQRFPackets::statuses::OK && this->error == errors::NO_ERROR) {
+			this->error = errors::TX_ERROR;
+		}
+		this->doneMs = millis();
+		this->status = (this->error == errors::NO_ERROR) ? statuses::DONE : statuses::FAILED;
+		return true;
+	}
+	if (this->readPacketId && packetId == this->readPacketId) {
+		this->readPacketId = 0;
+		if (!this->blockReady) {
+			// the block was discarded after an error
+			this->readCount = 0;
+			this->blockWritten = false;
+			return true;
+		}
+		bool equal = false;
+		if (packetResult == IQRFPackets::statuses::OK) {
+			// content of TR module was returned in place of request padding
+			uint8_t content[PACKET_SIZE - 4];
+			this->iqrf->getData(content, this->blockLength);
+			equal = !memcmp(&content[2], &this->block[2], this->blockLength - 2);
+		}
+		if (this->blockWritten) {
+			if (equal && this->readCount == 0) {
+				// the block is read again with other padding, echoed padding can not match both reads
+				this->readCount = 1;
+				return true;
+			}
+			if (equal) {
+				this->readBackStatus = readBackStatuses::READ_BACK_VERIFIED;
+			} else if (packetResult == IQRFPackets::statuses::OK) {
+				// TR module does not return EEPROM content in programming mode
+				this->readBackStatus = readBackStatuses::READ_BACK_FAILED;
+			}
+			// read back is verified on the next block if the read packet failed
+			this->readCount = 0;
+			this->blockWritten = false;
+			this->blockLength = 0;
+			this->blockReady = false;
+			return true;
+		}
+		if (equal) {
+			this->skippedBlockCount++;
+			this->blockLength = 0;
+			this->blockReady = false;
+			return true;
+		}
+		// changed block or block which was not read back is written
+		this->blockVerified = true;
+		return true;
+	}
+	for (uint8_t i = 0; i < this->windowCount; i++) {
+		if (this->window[i] == packetId) {
+			if (packetResult == IQRFPackets::statuses::OK) {
+				this->byteCount += this->windowLength[i];
+				this->packetCount++;
+			} else {
+				this->fail(errors::TX_ERROR);
+			}
+			this->windowCount--;
+			for (; i < this->windowCount; i++) {
+				this->window[i] = this->window[i + 1];
+				this->windowLength[i] = this->windowLength[i + 1];
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Get programmer status
+ * @return Programmer status (see IQRFProgrammer::statuses)
+ */
+uint8_t IQRFProgrammer::getStatus() {
+	return this->status;
+}
+
+/**
+ * Get programmer error
+ * @return Programmer error (see IQRFProgrammer::errors)
+ */
+uint8_t IQRFProgrammer::getError() {
+	return this->error;
+}
+
+/**
+ * Get number of parsed line of the image, it locates format and checksum errors
+ * @return Line number
+ */
+unsigned long IQRFProgrammer::getLineNumber() {
+	return this->lineNumber;
+}
+
+/**
+ * Get count of data bytes written to TR module
+ * @return Count of written data bytes
+ */
+unsigned long IQRFProgrammer::getByteCount() {
+	return this->byteCount;
+}
+
+/**
+ * Get count of packets written to TR module
+ * @return Count of written packets
+ */
+unsigned long IQRFProgrammer::getPacketCount() {
+	return this->packetCount;
+}
+
+/**
+ * Get upload speed from entering programming mode to the last written packet
+ * @return Written data bytes per second
+ */
+unsigned long IQRFProgrammer::getBytesPerSecond() {
+	if (this->status == statuses::IDLE || this->status == statuses::ENTER_PGM || this->byteCount == 0) {
+		return 0;
+	}
+	unsigned long elapsedMs = ((this->status == statuses::UPLOAD || this->status == statuses::FLUSH) ? millis() : this->endMs) - this->startMs;
+	return elapsedMs ? (this->byteCount * 1000) / elapsedMs : 0;
+}
+
+/**
+ * Get count of blocks which were not written in delta mode, because TR module already contains them
+ * @return Count of skipped blocks
+ */
+unsigned long IQRFProgrammer::getSkippedBlockCount() {
+	return this->skippedBlockCount;
+}
+
+/**
+ * Get total time of programming including entry to programming mode and read back of blocks
+ * @return Time from begin() to the end of programming in ms
+ */
+unsigned long IQRFProgrammer::getTotalTime() {
+	if (this->status == statuses::IDLE) {
+		return 0;
+	}
+	return ((this->status == statuses::DONE || this->status == statuses::FAILED) ? this->doneMs : millis()) - this->beginMs;
+}
+
+/**
+ * Enable delta mode, EEPROM blocks are read back by EEPROM_READ before writing and unchanged blocks are skipped
+ * Flash can not be read back by SPI, so flash blocks and plugins are always written
+ * EEPROM_READ is a debug mode command and its response in programming mode is not documented,
+ * so the first EEPROM block is written and then read back with padding 0x00 and 0xFF.
+ * Blocks are skipped only after both reads returned the written data, otherwise all blocks are written
+ * (see getReadBackStatus())
+ */
+void IQRFProgrammer::enableDeltaMode() {
+	this->deltaMode = true;
+}
+
+/**
+ * Disable delta mode, all blocks are written
+ */
+void IQRFProgrammer::disableDeltaMode() {
+	this->deltaMode = false;
+}
+
+/**
+ * Check if delta mode is enabled
+ * @return Delta mode is enabled
+ */
+bool IQRFProgrammer::isDeltaModeEnabled() {
+	return this->deltaMode;
+}
+
+/**
+ * Get status of EEPROM read back in delta mode
+ * @return Read back status (see IQRFProgrammer::readBackStatuses)
+ */
+uint8_t IQRFProgrammer::getReadBackStatus() {
+	return this->readBackStatus;
+}
+
+/**
+ * Get retry policy of programming packets, it can be changed after begin()
+ * @return Retry policy of programming packets
+ */
+IQRFRetryPolicy& IQRFProgrammer::getRetryPolicy() {
+	return this->retryPolicy;
+}
+
+/**
+ * Parse one character of the image
+ * @param c Character
+ */
+void IQRFProgrammer::parse(int c) {
+	if (c == '\n') {
+		this->lineNumber++;
+	}
+	if (this->format == formats::PLUGIN_FORMAT) {
+		if (this->comment) {
+			this->comment = (c != '\n');
+			return;
+		}
+		if (c == '#' && this->blockLength == 0 && !this->nibble) {
+			this->comment = true;
+			return;
+		}
+		if (c == '\n') {
+			if (this->nibble) {
+				this->fail(errors::FORMAT_ERROR);
+			} else if (this->blockLength) {
+				// every data line is one packet
+				this->blockCmd = IQRFSPI::commands::PLUGIN_PGM;
+				this->blockReady = true;
+			}
+			return;
+		}
+	} else if (c == ':') {
+		if (this->recordIndex >= 0) {
+			this->fail(errors::FORMAT_ERROR);
+			return;
+		}
+		this->recordIndex = 0;
+		this->recordChecksum = 0;
+		this->nibble = false;
+		return;
+	}
+	if (c == '\r' || c == '\n' || c == ' ' || c == '\t') {
+		// records must not be split
+		if (this->recordIndex >= 0 || this->nibble) {
+			this->fail(errors::FORMAT_ERROR);
+		}
+		return;
+	}
+	uint8_t digit;
+	if (c >= '0' && c <= '9') {
+		digit = c - '0';
+	} else if (c >= 'A' && c <= 'F') {
+		digit = c - 'A' + 10;
+	} else if (c >= 'a' && c <= 'f') {
+		digit = c - 'a' + 10;
+	} else {
+		this->fail(errors::FORMAT_ERROR);
+		return;
+	}
+	if (this->format == formats::HEX_FORMAT && this->recordIndex < 0) {
+		this->fail(errors::FORMAT_ERROR);
+		return;
+	}
+	this->parseHex(digit);
+}
+
+/**
+ * Parse one hexadecimal digit of the image
+ * @param digit Value of the digit
+ */
+void IQRFProgrammer::parseHex(uint8_t digit) {
+	if (!this->nibble) {
+		this->hexByte = digit << 4;
+		this->nibble = true;
+		return;
+	}
+	this->hexByte |= digit;
+	this->nibble = false;
+	if (this->format == formats::PLUGIN_FORMAT) {
+		if (this->blockLength == sizeof(this->block)) {
+			this->fail(errors::FORMAT_ERROR);
+			return;
+		}
+		this->block[this->blockLength++] = this->hexByte;
+		return;
+	}
+	this->recordChecksum += this->hexByte;
+	switch (this->recordIndex) {
+		case 0:
+			if (this->hexByte > PGM_RECORD_SIZE) {
+				this->fail(errors::FORMAT_ERROR);
+				return;
+			}
+			this->recordLength = this->hexByte;
+			break;
+		case 1:
+			this->recordAddress = (uint16_t) this->hexByte << 8;
+			break;
+		case 2:
+			this->recordAddress |= this->hexByte;
+			break;
+		case 3:
+			this->recordType = this->hexByte;
+			break;
+		default:
+			if (this->recordIndex - 4 < this->recordLength) {
+				this->recordData[this->recordIndex - 4] = this->hexByte;
+				break;
+			}
+			// checksum byte, sum of all record bytes is zero
+			this->recordIndex = -1;
+			if (this->recordChecksum) {
+				this->fail(errors::CHECKSUM_ERROR);
+			} else {
+				this->parseRecord();
+			}
+			return;
+	}
+	this->recordIndex++;
+}
+
+/**
+ * Process verified Intel HEX record
+ */
+void IQRFProgrammer::parseRecord() {
+	switch (this->recordType) {
+		case 0x00:
+			// data record is placed to blocks byte by byte
+			this->recordOffset = 0;
+			this->recordPending = true;
+			break;
+		case 0x01:
+			// end of file record
+			if (this->blockLength) {
+				this->blockReady = true;
+			}
+			this->status = statuses::FLUSH;
+			break;
+		case 0x02:
+			// extended segment address record
+			if (this->recordLength != 2) {
+				this->fail(errors::FORMAT_ERROR);
+				break;
+			}
+			this->baseAddress = (((unsigned long) this->recordData[0] << 8) | this->recordData[1]) << 4;
+			break;
+		case 0x04:
+			// extended linear address record
+			if (this->recordLength != 2) {
+				this->fail(errors::FORMAT_ERROR);
+				break;
+			}
+			this->baseAddress = (((unsigned long) this->recordData[0] << 8) | this->recordData[1]) << 16;
+			break;
+		case 0x03:
+		case 0x05:
+			// start address records are not used by TR module
+			break;
+		default:
+			this->fail(errors::FORMAT_ERROR);
+			break;
+	}
+}
+
+/**
+ * Place data of Intel HEX record to blocks
+ * Flash is written in aligned blocks of PGM_BLOCK_SIZE bytes with word address,
+ * EEPROM bytes are stored in low bytes of words, other addresses are skipped
+ * @return Record was placed, otherwise the block must be sent first
+ */
+bool IQRFProgrammer::placeRecord() {
+	for (; this->recordOffset < this->recordLength; this->recordOffset++) {
+		unsigned long address = this->baseAddress + this->recordAddress + this->recordOffset;
+		uint8_t cmd;
+		if (address < PGM_FLASH_END) {
+			cmd = IQRFSPI::commands::FLASH_PGM;
+		} else if (address >= PGM_EEPROM_ADDRESS && address < PGM_EEPROM_END && !(address & 1)) {
+			cmd = IQRFSPI::commands::EEPROM_PGM;
+		} else {
+			continue;
+		}
+		if (this->blockLength) {
+			bool fits;
+			if (cmd != this->blockCmd) {
+				fits = false;
+			} else if (cmd == IQRFSPI::commands::FLASH_PGM) {
+				fits = address - this->blockAddress < PGM_BLOCK_SIZE;
+			} else {
+				fits = address == this->blockAddress + 2 * (this->blockLength - 2) && this->blockLength - 2 < PGM_BLOCK_SIZE;
+			}
+			if (!fits) {
+				this->blockReady = true;
+				return false;
+			}
+		} else {
+			uint16_t target;
+			this->blockCmd = cmd;
+			if (cmd == IQRFSPI::commands::FLASH_PGM) {
+				// unwritten words of the block stay erased
+				this->blockAddress = address & ~((unsigned long) PGM_BLOCK_SIZE - 1);
+				target = this->blockAddress >> 1;
+				memset(&this->block[2], 0xFF, PGM_BLOCK_SIZE);
+				this->blockLength = PGM_BLOCK_SIZE + 2;
+			} else {
+				this->blockAddress = address;
+				target = (address - PGM_EEPROM_ADDRESS) >> 1;
+				this->blockLength = 2;
+			}
+			this->block[0] = target & 0xFF;
+			this->block[1] = target >> 8;
+		}
+		if (cmd == IQRFSPI::commands::FLASH_PGM) {
+			this->block[2 + address - this->blockAddress] = this->recordData[this->recordOffset];
+		} else {
+			this->block[this->blockLength++] = this->recordData[this->recordOffset];
+		}
+	}
+	this->recordPending = false;
+	return true;
+}
+
+/**
+ * Send complete block to Tx queue
+ * In delta mode EEPROM block is read back first, the block is skipped in txDone() if it is unchanged.
+ * Until read back is verified, EEPROM block is written first and read back after it
+ * Read request has the address of the block and padding in place of data, like IQRFMemoryDump
+ * @return Block was queued, otherwise the window or Tx queue is full or the block is read back
+ */
+bool IQRFProgrammer::sendBlock() {
+	if (this->readPacketId || this->windowCount == PGM_WINDOW || !this->iqrf->canSendData(this->blockLength)) {
+		return false;
+	}
+	bool readBack = this->deltaMode && this->blockCmd == IQRFSPI::commands::EEPROM_PGM && !this->blockVerified;
+	if (readBack && (this->readBackStatus == readBackStatuses::READ_BACK_VERIFIED || this->blockWritten)) {
+		// read packet has the same address and length as write packet, second read of written block is padded by 0xFF
+		uint8_t request[PACKET_SIZE - 4];
+		memset(request, this->readCount ? 0xFF : 0x00, sizeof(request));
+		request[0] = this->block[0];
+		request[1] = this->block[1];
+		this->readPacketId = this->iqrf->sendSpiPacket(IQRFSPI::commands::EEPROM_READ, request, this->blockLength, 0, IQRFPackets::priorities::NORMAL_PRIORITY, &this->retryPolicy);
+		if (this->readPacketId) {
+			this->activityMs = millis();
+		}
+		return false;
+	}
+	uint8_t packetId = this->iqrf->sendSpiPacket(this->blockCmd, this->block, this->blockLength, 0, IQRFPackets::priorities::NORMAL_PRIORITY, &this->retryPolicy);
+	if (!packetId) {
+		return false;
+	}
+	this->window[this->windowCount] = packetId;
+	// plugin lines are counted whole, address of Intel HEX blocks is not data
+	this->windowLength[this->windowCount] = (this->format == formats::PLUGIN_FORMAT) ? this->blockLength : this->blockLength - 2;
+	this->windowCount++;
+	this->activityMs = millis();
+	if (readBack && this->readBackStatus == readBackStatuses::READ_BACK_UNVERIFIED) {
+		// Tx queue keeps order, so the block is read back after it is written
+		this->blockWritten = true;
+		return true;
+	}
+	this->blockLength = 0;
+	this->blockReady = false;
+	this->blockVerified = false;
+	return true;
+}
+
+/**
+ * Stop parsing of the image after an error, TR module leaves programming mode when sent packets are finished
+ * @param error Programmer error (see IQRFProgrammer::errors)
+ */
+void IQRFProgrammer::fail(uint8_t error) {
+	if (this->error == errors::NO_ERROR) {
+		this->error = error;
+	}
+	this->blockReady = false;
+	this->blockVerified = false;
+	this->blockWritten = false;
+	this->blockLength = 0;
+	this->recordPending = false;
+	if (this->status == statuses::UPLOAD) {
+		this->status = statuses::FLUSH;
+	}
+}
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFPROGRAMMER_H
+#define IQRFPROGRAMMER_H
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+#include <stdint.h>
+
+#include "IQRFBase.h"
+#include "IQRFRetryPolicy.h"
+#include "IQRFSettings.h"
+
+/**
+ * Streaming programmer of TR module
+ * Intel HEX image or IQRF plugin is parsed from a stream record by record
+ * and written to TR module in programming mode, the whole image is never buffered
+ */
+class IQRFProgrammer {
+public:
+	bool begin(IQRFBase *iqrf, Stream *stream, uint8_t format);
+	bool task();
+	bool txDone(uint8_t packetId, uint8_t packetResult);
+	uint8_t getStatus();
+	uint8_t getError();
+	unsigned long getLineNumber();
+	unsigned long getByteCount();
+	unsigned long getPacketCount();
+	unsigned long getBytesPerSecond();
+	unsigned long getSkippedBlockCount();
+	unsigned long getTotalTime();
+	void enableDeltaMode();
+	void disableDeltaMode();
+	bool isDeltaModeEnabled();
+	uint8_t getReadBackStatus();
+	IQRFRetryPolicy& getRetryPolicy();
+
+	/**
+	 * Formats of programmed image
+	 */
+	enum formats {
+		HEX_FORMAT = 0, //!< Intel HEX, flash and EEPROM are distinguished by address
+		PLUGIN_FORMAT = 1 //!< IQRF plugin, every data line is one packet
+	};
+
+	/**
+	 * Programmer statuses
+	 */
+	enum statuses {
+		IDLE = 0, //!< Programming was not started
+		ENTER_PGM = 1, //!< TR module enters programming mode
+		UPLOAD = 2, //!< Image is parsed and written
+		FLUSH = 3, //!< Last packets are written
+		END_PGM = 4, //!< TR module leaves programming mode
+		DONE = 5, //!< Image was written
+		FAILED = 6 //!< Programming failed (see getError())
+	};
+
+	/**
+	 * Programmer errors
+	 */
+	enum errors {
+		NO_ERROR = 0, //!< No error
+		MODE_ERROR = 1, //!< TR module did not enter programming mode
+		FORMAT_ERROR = 2, //!< Invalid character or record in the image
+		CHECKSUM_ERROR = 3, //!< Checksum of Intel HEX record does not match
+		STREAM_ERROR = 4, //!< Stream ended before end of Intel HEX image
+		TX_ERROR = 5 //!< TR module did not accept a packet
+	};
+
+	/**
+	 * Statuses of EEPROM read back in delta mode
+	 */
+	enum readBackStatuses {
+		READ_BACK_UNVERIFIED = 0, //!< No written block was read back yet, blocks are written
+		READ_BACK_VERIFIED = 1, //!< Written block was read back, unchanged blocks are skipped
+		READ_BACK_FAILED = 2 //!< Written block was not read back, all blocks are written
+	};
+private:
+	void parse(int c);
+	void parseHex(uint8_t digit);
+	void parseRecord();
+	bool placeRecord();
+	bool sendBlock();
+	void fail(uint8_t error);
+	/// IQRF driver
+	IQRFBase *iqrf;
+	/// Stream with the image
+	Stream *stream;
+	/// Retry policy of programming packets, TR module is busy while it writes flash
+	IQRFRetryPolicy retryPolicy;
+	/// Format of the image
+	uint8_t format;
+	/// Programmer status
+	uint8_t status = statuses::IDLE;
+	/// Programmer error
+	uint8_t error;
+	/// Number of parsed line of the image
+	unsigned long lineNumber;
+	/// Stream is in comment line of plugin
+	bool comment;
+	/// High nibble was parsed, low nibble follows
+	bool nibble;
+	/// Parsed byte
+	uint8_t hexByte;
+	/// Index of parsed byte in Intel HEX record, -1 out of record
+	int16_t recordIndex;
+	/// Checksum of Intel HEX record
+	uint8_t recordChecksum;
+	/// Type of Intel HEX record
+	uint8_t recordType;
+	/// Address of Intel HEX record
+	uint16_t recordAddress;
+	/// Data length of Intel HEX record
+	uint8_t recordLength;
+	/// Data of Intel HEX record
+	uint8_t recordData[PGM_RECORD_SIZE];
+	/// Count of record data placed to the block
+	uint8_t recordOffset;
+	/// Record is verified and waits for placing to the block
+	bool recordPending;
+	/// Base address from extended address records
+	unsigned long baseAddress;
+	/// SPI command of the block
+	uint8_t blockCmd;
+	/// Image address of the first byte in the block
+	unsigned long blockAddress;
+	/// Data length of the block
+	uint8_t blockLength;
+	/// Block is complete and waits for sending
+	bool blockReady;
+	/// Block differs from content of TR module or can not be read back, it is written
+	bool blockVerified;
+	/// Block was written and it is kept until it is read back
+	bool blockWritten;
+	/// Delta mode (EEPROM blocks are read back and unchanged ones are skipped)
+	bool deltaMode = false;
+	/// Status of EEPROM read back (see IQRFProgrammer::readBackStatuses)
+	uint8_t readBackStatus;
+	/// ID of read back packet of the block or 0
+	uint8_t readPacketId;
+	/// Count of read backs of the written block
+	uint8_t readCount;
+	/// Packet data, address and data of the block
+	uint8_t block[PACKET_SIZE - 4];
+	/// IDs of sent packets which were not finished yet
+	uint8_t window[PGM_WINDOW];
+	/// Data lengths of sent packets which were not finished yet
+	uint8_t windowLength[PGM_WINDOW];
+	/// Count of packets in the window
+	uint8_t windowCount;
+	/// ID of end of programming mode packet
+	uint8_t endPacketId;
+	/// Count of written data bytes
+	unsigned long byteCount;
+	/// Count of written packets
+	unsigned long packetCount;
+	/// Count of blocks skipped in delta mode
+	unsigned long skippedBlockCount;
+	/// Start of programming in ms
+	unsigned long beginMs;
+	/// End of programming in ms
+	unsigned long doneMs;
+	/// Start of upload in ms
+	unsigned long startMs;
+	/// End of upload in ms
+	unsigned long endMs;
+	/// Time of last activity in ms, it is used for timeouts
+	unsigned long activityMs;
+};
+
+#endif
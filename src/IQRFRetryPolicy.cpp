@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IQRFRetryPolicy.h"
+
+#if defined(__PIC32MX__)
+#include <WProgram.h>
+#else
+#include <Arduino.h>
+#endif
+
+/**
+ * Set maximal count of attempts to send a packet
+ * @param attempts Maximal count of attempts, at least one attempt is made
+ */
+void IQRFRetryPolicy::setMaxAttempts(uint8_t attempts) {
+	this->maxAttempts = attempts ? attempts : 1;
+}
+
+/**
+ * Get maximal count of attempts to send a packet
+ * @return Maximal count of attempts
+ */
+uint8_t IQRFRetryPolicy::getMaxAttempts() {
+	return this->maxAttempts;
+}
+
+/**
+ * Set backoff between attempts, it is doubled after each failed attempt up to maxUs
+ * @param initialUs Backoff before the first retry in us
+ * @param maxUs Maximal backoff in us
+ */
+void IQRFRetryPolicy::setBackoff(unsigned long initialUs, unsigned long maxUs) {
+	if (maxUs < initialUs) {
+		maxUs = initialUs;
+	}
+	this->initialBackoff = initialUs;
+	this->maxBackoff = maxUs;
+}
+
+/**
+ * Get backoff before the first retry
+ * @return Backoff before the first retry in us
+ */
+unsigned long IQRFRetryPolicy::getInitialBackoff() {
+	return this->initialBackoff;
+}
+
+/**
+ * Get maximal backoff
+ * @return Maximal backoff in us
+ */
+unsigned long IQRFRetryPolicy::getMaxBackoff() {
+	return this->maxBackoff;
+}
+
+/**
+ * Set random jitter of backoff, it spreads retries of more packets or more TR modules
+ * @param percent Jitter in percent of backoff (0 - 100)
+ */
+void IQRFRetryPolicy::setJitter(uint8_t percent) {
+	this->jitter = percent > 100 ? 100 : percent;
+}
+
+/**
+ * Get random jitter of backoff
+ * @return Jitter in percent of backoff
+ */
+uint8_t IQRFRetryPolicy::getJitter() {
+	return this->jitter;
+}
+
+/**
+ * Set deadline of a packet, packet which is not sent until the deadline fails
+ * @param ms Deadline from enqueue of the packet in ms (less than 71 minutes), 0 for no deadline
+ */
+void IQRFRetryPolicy::setDeadline(unsigned long ms) {
+	this->deadline = ms;
+}
+
+/**
+ * Get deadline of a packet
+ * @return Deadline from enqueue of the packet in ms, 0 for no deadline
+ */
+unsigned long IQRFRetryPolicy::getDeadline() {
+	return this->deadline;
+}
+
+/**
+ * Check if deadline of a packet elapsed
+ * @param queuedUs Time of packet enqueue in us
+ * @param nowUs Actual time in us
+ * @return Deadline elapsed
+ */
+bool IQRFRetryPolicy::isExpired(unsigned long queuedUs, unsigned long nowUs) {
+	return this->deadline && (nowUs - queuedUs) / 1000 >= this->deadline;
+}
+
+/**
+ * Get backoff before a retry
+ * @param retry Number of the retry (1 for the first retry)
+ * @return Backoff in us
+ */
+unsigned long IQRFRetryPolicy::getBackoff(uint8_t retry) {
+	unsigned long backoff = this->initialBackoff;
+	for (uint8_t i = 1; i < retry && backoff < this->maxBackoff; i++) {
+		backoff <<= 1;
+	}
+	if (backoff > this->maxBackoff) {
+		backoff = this->maxBackoff;
+	}
+	// random jitter in range <-jitter, +jitter>
+	unsigned long range = backoff / 100 * this->jitter;
+	if (range) {
+		backoff = backoff - range + random(2 * range + 1);
+	}
+	return backoff;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFRETRYPOLICY_H
+#define IQRFRETRYPOLICY_H
+
+#include <stdint.h>
+
+#include "IQRFSettings.h"
+
+/**
+ * Retry policy of Tx packets
+ * Failed packet is sent again after exponential backoff with random jitter,
+ * it fails after maximal count of attempts or when its deadline elapses
+ */
+class IQRFRetryPolicy {
+public:
+	void setMaxAttempts(uint8_t attempts);
+	uint8_t getMaxAttempts();
+	void setBackoff(unsigned long initialUs, unsigned long maxUs);
+	unsigned long getInitialBackoff();
+	unsigned long getMaxBackoff();
+	void setJitter(uint8_t percent);
+	uint8_t getJitter();
+	void setDeadline(unsigned long ms);
+	unsigned long getDeadline();
+	bool isExpired(unsigned long queuedUs, unsigned long nowUs);
+	unsigned long getBackoff(uint8_t retry);
+private:
+	/// Maximal count of attempts to send a packet
+	uint8_t maxAttempts = RETRY_ATTEMPTS;
+	/// Backoff before the first retry in us
+	unsigned long initialBackoff = RETRY_BACKOFF;
+	/// Maximal backoff in us
+	unsigned long maxBackoff = RETRY_MAX_BACKOFF;
+	/// Random jitter of backoff in percent
+	uint8_t jitter = RETRY_JITTER;
+	/// Deadline of a packet from its enqueue in ms, 0 for no deadline
+	unsigned long deadline = RETRY_DEADLINE;
+};
+
+#endif
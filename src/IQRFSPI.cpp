@@ -127,4 +127,119 @@ unsigned long IQRFSPI::getBytePause() {
  */
 void IQRFSPI::setBytePause(unsigned long time) {
 	this->bytePause = time;
+}
+
+/**
+ * Enable burst mode, whole SPI packet is transferred in one driver call
+ */
+void IQRFSPI::enableBurstMode() {
+	this->burstMode = true;
+}
+
+/**
+ * Disable burst mode, one byte of SPI packet is transferred per driver call
+ */
+void IQRFSPI::disableBurstMode() {
+	this->burstMode = false;
+}
+
+/**
+ * Get burst mode status
+ * @return Burst mode status
+ */
+bool IQRFSPI::isBurstModeEnabled() {
+	return this->burstMode;
+}
+
+/**
+ * Enable drain mode, SPI status is checked right after packet transfer and
+ * next packets are transferred in the same driver call while TR module is ready
+ * @param holdTime Time of one driver call in us, after it no next packet is started
+ */
+void IQRFSPI::enableDrainMode(unsigned long holdTime) {
+	this->drainMode = true;
+	this->drainHoldTime = holdTime;
+}
+
+/**
+ * Disable drain mode
+ */
+void IQRFSPI::disableDrainMode() {
+	this->drainMode = false;
+}
+
+/**
+ * Get drain mode status
+ * @return Drain mode status
+ */
+bool IQRFSPI::isDrainModeEnabled() {
+	return this->drainMode;
+}
+
+/**
+ * Get maximal time of one driver call in drain mode
+ * @return Maximal time of one driver call in us
+ */
+unsigned long IQRFSPI::getDrainHoldTime() {
+	return this->drainHoldTime;
+}
+
+/**
+ * Get duration of last SPI packet transfer in us
+ * @return Duration of last SPI packet transfer in us
+ */
+unsigned long IQRFSPI::getFrameTime() {
+	return this->frameTime;
+}
+
+/**
+ * Set duration of last SPI packet transfer in us
+ * @param time Duration of last SPI packet transfer in us
+ */
+void IQRFSPI::setFrameTime(unsigned long time) {
+	this->frameTime = time;
+}
+
+/**
+ * Get result of last SPI packet transfer
+ * @return Result of last SPI packet transfer (see frameResults)
+ */
+uint8_t IQRFSPI::getFrameResult() {
+	return this->frameResult;
+}
+
+/**
+ * Set result of last SPI packet transfer
+ * @param result Result of last SPI packet transfer (see frameResults)
+ */
+void IQRFSPI::setFrameResult(uint8_t result) {
+	this->frameResult = result;
+}
+
+/**
+ * Classify SPI status returned by TR module on the first byte of SPI packet
+ * @param status SPI status returned on SPI command
+ * @return FRAME_OK if TR module can accept the packet, otherwise reason of the abort
+ */
+uint8_t IQRFSPI::classifyStatus(uint8_t status) {
+	switch (status) {
+		case statuses::NO_MODULE:
+		case statuses::DISABLED:
+			return frameResults::FRAME_NO_MODULE;
+		case statuses::BUSY:
+			return frameResults::FRAME_BUSY;
+		case statuses::CRCM_OK:
+		case statuses::CRCM_ERR:
+			return frameResults::FRAME_BUFFER_FULL;
+		case statuses::COMMUNICATION_MODE:
+		case statuses::PROGRAMMING_MODE:
+		case statuses::DEBUG_MODE:
+			return frameResults::FRAME_OK;
+		default:
+			// data ready
+			if ((status & 0xC0) == 0x40) {
+				return frameResults::FRAME_OK;
+			}
+			return frameResults::FRAME_NOT_READY;
+	}
 }
\ No newline at end of file
@@ -43,6 +43,18 @@ public:
 	bool isFastSpiEnabled();
 	unsigned long getBytePause();
 	void setBytePause(unsigned long time);
+	void enableBurstMode();
+	void disableBurstMode();
+	bool isBurstModeEnabled();
+	void enableDrainMode(unsigned long holdTime);
+	void disableDrainMode();
+	bool isDrainModeEnabled();
+	unsigned long getDrainHoldTime();
+	unsigned long getFrameTime();
+	void setFrameTime(unsigned long time);
+	uint8_t getFrameResult();
+	void setFrameResult(uint8_t result);
+	uint8_t classifyStatus(uint8_t status);
 
 	/**
 	 * SPI status of TR module (see IQRF SPI user manual)
@@ -83,6 +95,18 @@ public:
 		FLASH_PGM = 0xF6, //!< Master writes data to flash in programming mode
 		PLUGIN_PGM = 0xF9 //!< Master writes plugin data to flash in programming mode
 	};
+
+	/**
+	 * Results of SPI packet transfer
+	 */
+	enum frameResults {
+		FRAME_OK = 0, //!< Packet transferred, CRCM and CRCS ok
+		FRAME_CRC_ERROR = 1, //!< Packet transferred, CRCM or CRCS error
+		FRAME_BUSY = 2, //!< Packet aborted, TR module busy
+		FRAME_NO_MODULE = 3, //!< Packet aborted, SPI of TR module not working
+		FRAME_BUFFER_FULL = 4, //!< Packet aborted, buffer COM of TR module full
+		FRAME_NOT_READY = 5 //!< Packet aborted, TR module is not ready for the packet
+	};
 private:
 	/// SPI master status (ON/OFF)
 	bool master;
@@ -94,6 +118,16 @@ private:
 	bool fastSpi;
 	/// SPI byte to byte pause in us
 	unsigned long bytePause;
+	/// Burst mode (whole packet in one driver call)
+	bool burstMode;
+	/// Drain mode (next packet right after previous one)
+	bool drainMode;
+	/// Maximal time of one driver call in drain mode in us
+	unsigned long drainHoldTime;
+	/// Duration of last SPI packet transfer in us
+	unsigned long frameTime;
+	/// Result of last SPI packet transfer
+	uint8_t frameResult;
 };
 
 #endif
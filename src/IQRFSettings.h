@@ -24,11 +24,131 @@
 
 #define PACKET_SIZE        68          //!< Size of SPI TX and RX buffer
 #define PACKET_BUFFER_SIZE 32          //!< Size of SPI TX packet buffer
+#if !defined(PACKET_BUFFER_HIGH_SIZE)
+#define PACKET_BUFFER_HIGH_SIZE 4      //!< Size of high priority SPI TX packet buffer
+#endif
+#if !defined(PACKET_ARENA_HIGH_SIZE)
+#define PACKET_ARENA_HIGH_SIZE 128     //!< Size of high priority SPI TX packet data arena
+#endif
+#if !defined(RX_FRAME_COUNT)
+#define RX_FRAME_COUNT     2           //!< Count of SPI RX frames (2 = double buffering)
+#endif
+#if !defined(RX_QUEUE_DEPTH)
+#define RX_QUEUE_DEPTH     255         //!< Maximal count of frames in Rx queue, at most Rx frames - 1, so a frame stays free for reading of TR module
+#endif
+#if !defined(PACKET_ARENA_SIZE)
+#define PACKET_ARENA_SIZE  256         //!< Size of SPI TX packet data arena
+#endif
 
 // Timing
 #define MICRO_SECOND       1000000      //!< Microsecond
 #define MILLI_SECOND       1000         //!< Milisecond
 
+// SPI status polling
+#if !defined(POLL_MIN_INTERVAL)
+#define POLL_MIN_INTERVAL  1000         //!< Status polling interval after traffic in us
+#endif
+#if !defined(POLL_MAX_INTERVAL)
+#define POLL_MAX_INTERVAL  10000        //!< Status polling interval in idle state in us
+#endif
+
+// Retry policy of Tx packets
+#if !defined(RETRY_ATTEMPTS)
+#define RETRY_ATTEMPTS     3            //!< Maximal count of attempts to send a Tx packet
+#endif
+#if !defined(RETRY_BACKOFF)
+#define RETRY_BACKOFF      1000         //!< Backoff before the first retry in us
+#endif
+#if !defined(RETRY_MAX_BACKOFF)
+#define RETRY_MAX_BACKOFF  16000        //!< Maximal backoff between retries in us
+#endif
+#if !defined(RETRY_JITTER)
+#define RETRY_JITTER       25           //!< Random jitter of backoff in percent
+#endif
+#if !defined(RETRY_DEADLINE)
+#define RETRY_DEADLINE     0            //!< Deadline of a Tx packet from its enqueue in ms, 0 for no deadline
+#endif
+
+// Tracker of Tx packets
+#if !defined(TRACKER_RECORDS)
+#define TRACKER_RECORDS    4            //!< Count of last completed Tx packets with kept timestamps
+#endif
+#if !defined(TRACKER_BUCKETS)
+#define TRACKER_BUCKETS    16           //!< Count of latency histogram buckets, limits are 512 us, 1 ms, 2 ms ...
+#endif
+
+// TR module reset
+#if !defined(PGM_MIRROR_PCINT)
+#define PGM_MIRROR_PCINT   0            //!< MISO is copied to MOSI in PCINT0 interrupt on AVR, it can not be used with SoftwareSerial
+#endif
+#if !defined(PGM_ENTRY_TIMEOUT)
+#define PGM_ENTRY_TIMEOUT  500          //!< Timeout of programming mode SPI status after MISO to MOSI mirroring in ms
+#endif
+
+// Programming of TR module
+#if !defined(PGM_WINDOW)
+#define PGM_WINDOW         4            //!< Maximal count of programming packets in Tx queue and in transfer
+#endif
+#if !defined(PGM_ATTEMPTS)
+#define PGM_ATTEMPTS       10           //!< Maximal count of attempts to send a programming packet
+#endif
+#if !defined(PGM_TIMEOUT)
+#define PGM_TIMEOUT        2000         //!< Timeout of programming mode entry and of idle image stream in ms
+#endif
+#if !defined(PGM_RECORD_SIZE)
+#define PGM_RECORD_SIZE    32           //!< Maximal data length of Intel HEX record
+#endif
+#define PGM_BLOCK_SIZE     32           //!< Data bytes in one flash or EEPROM programming packet
+#define PGM_FLASH_END      0x8000UL     //!< End of flash in Intel HEX image (byte address)
+#define PGM_EEPROM_ADDRESS 0x1E000UL    //!< Start of EEPROM in Intel HEX image (byte address)
+#define PGM_EEPROM_END     0x1E200UL    //!< End of EEPROM in Intel HEX image (byte address)
+
+// Memory dump of TR module
+#if !defined(DUMP_WINDOW)
+#define DUMP_WINDOW        4            //!< Maximal count of read packets in Tx queue and in transfer
+#endif
+#if !defined(DUMP_CHUNK_SIZE)
+#define DUMP_CHUNK_SIZE    32           //!< Default count of bytes read by one packet
+#endif
+
+// DPA layer
+#if !defined(DPA_REQUESTS)
+#define DPA_REQUESTS       4            //!< Maximal count of outstanding DPA requests
+#endif
+#if !defined(DPA_TIMEOUT)
+#define DPA_TIMEOUT        1000         //!< Default timeout of DPA response in ms
+#endif
+
+// Bridge between serial line and TR module
+#if !defined(BRIDGE_RING_SIZE)
+#define BRIDGE_RING_SIZE   256          //!< Size of ring buffer of encoded frames for host
+#endif
+#if !defined(BRIDGE_CREDITS)
+#define BRIDGE_CREDITS     4            //!< Maximal count of data frames from host without result frame
+#endif
+#if !defined(BRIDGE_HELD_FRAMES)
+#define BRIDGE_HELD_FRAMES 2            //!< Maximal count of received frames held until they fit into ring buffer
+#endif
+#if !defined(BRIDGE_WRITE_SLICE)
+#define BRIDGE_WRITE_SLICE 32           //!< Maximal count of bytes written to serial line in one task call
+#endif
+#if !defined(BRIDGE_WRITE_AVAILABLE)
+#define BRIDGE_WRITE_AVAILABLE 1        //!< Writes are limited by availableForWrite() of serial line, 0 for streams which do not implement it
+#endif
+
+// Cache of TR module info
+#if !defined(IQRF_CACHE_ADDRESS)
+#define IQRF_CACHE_ADDRESS 0            //!< Address of TR module info record in EEPROM
+#endif
+#if (defined(__AVR__) || defined(CORE_TEENSY) || defined(__PIC32MX__)) && !defined(IQRF_EEPROM_CACHE)
+#define IQRF_EEPROM_CACHE               //!< EEPROM of MCU can be used as cache of TR module info
+#endif
+
+// TR modules sharing SPI bus
+#if !defined(IQRF_BUS_MODULES)
+#define IQRF_BUS_MODULES   4            //!< Maximal count of TR modules driven by IQRFBus
+#endif
+
 // Pins
 #if !defined(TR_RESET_PIN)
 #define TR_RESET_PIN        6           //!< TR reset pin
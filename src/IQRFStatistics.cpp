@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "IQRFSPI.h"
+#include "IQRFStatistics.h"
+
+/**
+ * Reset all counters
+ * @param nowUs Actual time in us
+ */
+void IQRFStatistics::begin(unsigned long nowUs) {
+	memset(&this->stats, 0, sizeof(this->stats));
+	this->lastMasterStatus = IQRFSPI::masterStatuses::FREE;
+	this->lastMasterUs = nowUs;
+}
+
+/**
+ * Count bytes transferred via SPI
+ * @param bytes Count of bytes
+ */
+void IQRFStatistics::clocked(uint8_t bytes) {
+	this->stats.bytesClocked += bytes;
+}
+
+/**
+ * Count SPI packet written to TR module
+ */
+void IQRFStatistics::written() {
+	this->stats.framesWritten++;
+}
+
+/**
+ * Count SPI packet read from TR module
+ */
+void IQRFStatistics::read() {
+	this->stats.framesRead++;
+}
+
+/**
+ * Count SPI packet with CRCM error reported by TR module
+ */
+void IQRFStatistics::crcmError() {
+	this->stats.crcmErrors++;
+}
+
+/**
+ * Count SPI packet with CRCS error
+ */
+void IQRFStatistics::crcsError() {
+	this->stats.crcsErrors++;
+}
+
+/**
+ * Count repeated attempt to send Tx packet
+ */
+void IQRFStatistics::retry() {
+	this->stats.retries++;
+}
+
+/**
+ * Count SPI packet aborted after the first byte
+ */
+void IQRFStatistics::aborted() {
+	this->stats.abortedFrames++;
+}
+
+/**
+ * Count SPI status poll and its result
+ * @param status SPI status of TR module (see IQRFSPI::statuses)
+ */
+void IQRFStatistics::polled(uint8_t status) {
+	uint8_t statusClass;
+	switch (status) {
+		case IQRFSPI::statuses::COMMUNICATION_MODE:
+			statusClass = STATUS_COMMUNICATION_MODE;
+			break;
+		case IQRFSPI::statuses::PROGRAMMING_MODE:
+			statusClass = STATUS_PROGRAMMING_MODE;
+			break;
+		case IQRFSPI::statuses::DEBUG_MODE:
+			statusClass = STATUS_DEBUG_MODE;
+			break;
+		case IQRFSPI::statuses::CRCM_OK:
+		case IQRFSPI::statuses::CRCM_ERR:
+			statusClass = STATUS_BUFFER_FULL;
+			break;
+		case IQRFSPI::statuses::BUSY:
+			statusClass = STATUS_BUSY;
+			break;
+		case IQRFSPI::statuses::NO_MODULE:
+		case IQRFSPI::statuses::DISABLED:
+			statusClass = STATUS_NO_MODULE;
+			break;
+		default:
+			statusClass = ((status & 0xC0) == 0x40) ? STATUS_DATA_READY : STATUS_OTHER;
+			break;
+	}
+	this->stats.pollCount++;
+	this->stats.statusCounts[statusClass]++;
+}
+
+/**
+ * Add time from last update to previous SPI master state and remember actual state
+ * @param masterStatus Actual SPI master state (see IQRFSPI::masterStatuses)
+ * @param nowUs Actual time in us
+ */
+void IQRFStatistics::masterState(uint8_t masterStatus, unsigned long nowUs) {
+	this->stats.masterTimeUs[this->lastMasterStatus] += nowUs - this->lastMasterUs;
+	this->lastMasterStatus = masterStatus;
+	this->lastMasterUs = nowUs;
+}
+
+/**
+ * Copy counters, Tx queue high water mark is added by the driver
+ * @param stats Snapshot of statistics
+ */
+void IQRFStatistics::snapshot(driverStats_t *stats) {
+	memcpy(stats, &this->stats, sizeof(driverStats_t));
+}
+
+/**
+ * Get count of SPI packets written to TR module
+ * @return Count of written packets
+ */
+unsigned long IQRFStatistics::getFramesWritten() {
+	return this->stats.framesWritten;
+}
+
+/**
+ * Get count of SPI packets read from TR module
+ * @return Count of read packets
+ */
+unsigned long IQRFStatistics::getFramesRead() {
+	return this->stats.framesRead;
+}
+
+/**
+ * Get count of SPI packets aborted after the first byte
+ * @return Count of aborted packets
+ */
+unsigned long IQRFStatistics::getAbortedFrames() {
+	return this->stats.abortedFrames;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFSTATISTICS_H
+#define IQRFSTATISTICS_H
+
+#include <stdint.h>
+
+/**
+ * Classes of SPI statuses returned by status polls
+ */
+enum spiStatusClasses {
+	STATUS_COMMUNICATION_MODE = 0, //!< SPI ready (communication mode)
+	STATUS_PROGRAMMING_MODE = 1, //!< SPI ready (programming mode)
+	STATUS_DEBUG_MODE = 2, //!< SPI ready (debugging mode)
+	STATUS_DATA_READY = 3, //!< Data ready in buffer COM of TR module
+	STATUS_BUFFER_FULL = 4, //!< SPI not ready, CRCM_OK or CRCM_ERR
+	STATUS_BUSY = 5, //!< SPI busy
+	STATUS_NO_MODULE = 6, //!< SPI not working, NO_MODULE or DISABLED
+	STATUS_OTHER = 7, //!< Other status (SLOW_MODE, USER_STOP, ...)
+	STATUS_CLASSES = 8 //!< Count of status classes
+};
+
+/**
+ * Snapshot of driver statistics
+ */
+typedef struct {
+	unsigned long bytesClocked; //!< Count of bytes transferred via SPI including status polls
+	unsigned long framesWritten; //!< Count of SPI packets written to TR module
+	unsigned long framesRead; //!< Count of SPI packets read from TR module
+	unsigned long crcmErrors; //!< Count of SPI packets with CRCM error reported by TR module
+	unsigned long crcsErrors; //!< Count of SPI packets with CRCS error
+	unsigned long retries; //!< Count of repeated attempts to send Tx packet
+	unsigned long abortedFrames; //!< Count of SPI packets aborted after the first byte
+	uint8_t txQueueHighWaterMark; //!< Maximal count of packets in Tx queue
+	unsigned long pollCount; //!< Count of SPI status polls
+	unsigned long statusCounts[STATUS_CLASSES]; //!< Count of polled SPI statuses by class (see spiStatusClasses)
+	unsigned long masterTimeUs[3]; //!< Time spent in SPI master states in us (see IQRFSPI::masterStatuses)
+} driverStats_t;
+
+/**
+ * Driver statistics, counters are only incremented, so they can stay enabled
+ */
+class IQRFStatistics {
+public:
+	void begin(unsigned long nowUs);
+	void clocked(uint8_t bytes);
+	void written();
+	void read();
+	void crcmError();
+	void crcsError();
+	void retry();
+	void aborted();
+	void polled(uint8_t status);
+	void masterState(uint8_t masterStatus, unsigned long nowUs);
+	void snapshot(driverStats_t *stats);
+	unsigned long getFramesWritten();
+	unsigned long getFramesRead();
+	unsigned long getAbortedFrames();
+private:
+	/// Counters
+	driverStats_t stats;
+	/// SPI master state at last update
+	uint8_t lastMasterStatus;
+	/// Time of last update of master state in us
+	unsigned long lastMasterUs;
+};
+
+#endif
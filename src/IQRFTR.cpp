@@ -20,65 +20,253 @@
  */
 
 #include "IQRFTR.h"
-#include "iqrf_library.h"
 
 /**
- * Reset TR module
+ * Copy MISO to MOSI, TR module enters programming mode when MOSI follows MISO
+ */
+static void mirrorMiso() {
+	digitalWrite(TR_MOSI_PIN, digitalRead(TR_MISO_PIN));
+}
+
+#if defined(__AVR__) && PGM_MIRROR_PCINT
+/**
+ * MISO changed, MISO pin must be on port B (PCINT0 interrupt), as on Uno, Leonardo and Mega
+ */
+ISR(PCINT0_vect) {
+	mirrorMiso();
+}
+#endif
+
+/**
+ * Use SPI of driver
+ * @param spi IQRF SPI of driver
+ * @param iqSpi SPI interface of driver
+ */
+void IQRFTR::begin(IQRFSPI *spi, IQSPI *iqSpi) {
+	this->spi = spi;
+	this->iqSpi = iqSpi;
+	this->resetStatus = resetStatuses::RESET_DONE;
+}
+
+/**
+ * Start reset of TR module, it continues in resetTask() called from driver
  */
 void IQRFTR::reset() {
-	if (spi->isMasterEnabled()) {
+	if (this->spi->isMasterEnabled()) {
+		this->programAfterReset = false;
+		this->programEntry = programEntryStatuses::PGM_ENTRY_NONE;
 		this->turnOff();
-		// RESET pause
-		delay(100);
-		this->turnOn();
-		delay(1);
+		this->resetStartUs = micros();
+		this->resetStatus = resetStatuses::POWER_OFF;
 	} else {
-		spi->setStatus(spi->statuses::BUSY);
+		this->spi->setStatus(this->spi->statuses::BUSY);
 	}
 }
 
 /**
- * TR module switch to programming mode
+ * Start switch of TR module to programming mode, it continues in resetTask() called from driver
  */
 void IQRFTR::enterProgramMode() {
-	if (spi->isMasterEnabled()) {
-		iqSpi->end();
+	if (this->spi->isMasterEnabled()) {
+		this->iqSpi->end();
 		this->reset();
-		pinMode(TR_SS_PIN, OUTPUT);
-		pinMode(TR_MOSI_PIN, OUTPUT);
-		pinMode(TR_MISO_PIN, INPUT);
-		digitalWrite(TR_SS_PIN, LOW);
-		unsigned long enterMs = millis();
-		do {
-			// Copy MOSI to MISO for approx. 500ms => TR into programming mode
-			digitalWrite(TR_MOSI_PIN, digitalRead(TR_MISO_PIN));
-		} while ((millis() - enterMs) < (MILLI_SECOND / 2));
-		iqSpi->begin();
+		this->programAfterReset = true;
+		this->programEntry = programEntryStatuses::PGM_ENTRY_PENDING;
+		// SPI status read before the reset is not valid, it is updated by next status check
+		this->spi->setStatus(this->spi->statuses::BUSY);
 	} else {
 		this->setControlStatus(controlStatuses::RESET);
 		this->enableProgramFlag();
-		spi->setStatus(spi->statuses::BUSY);
+		this->spi->setStatus(this->spi->statuses::BUSY);
+	}
+}
+
+/**
+ * Check if reset or switch to programming mode is in progress, SPI must not be used
+ * @return Reset is in progress
+ */
+bool IQRFTR::isResetting() {
+	return this->resetStatus != resetStatuses::RESET_DONE;
+}
+
+/**
+ * Advance reset or switch to programming mode, it must be called periodically while isResetting()
+ * MISO is copied to MOSI for 500 ms in interrupt if MISO pin has one (see attachMirror()),
+ * otherwise in one blocking call, so the entry does not depend on loop latency
+ */
+void IQRFTR::resetTask() {
+	unsigned long elapsedUs = micros() - this->resetStartUs;
+	switch (this->resetStatus) {
+		case resetStatuses::POWER_OFF:
+			// RESET pause
+			if (elapsedUs >= 100000UL) {
+				this->turnOn();
+				this->resetStartUs = micros();
+				this->resetStatus = resetStatuses::POWER_ON;
+			}
+			break;
+		case resetStatuses::POWER_ON:
+			if (elapsedUs >= 1000UL) {
+				if (this->programAfterReset) {
+					// MOSI is driven as GPIO, TR modules sharing the bus wait until the entry is finished
+					this->iqSpi->suspend();
+					pinMode(this->iqSpi->getSsPin(), OUTPUT);
+					pinMode(TR_MOSI_PIN, OUTPUT);
+					pinMode(TR_MISO_PIN, INPUT);
+					digitalWrite(this->iqSpi->getSsPin(), LOW);
+					this->resetStartUs = micros();
+					if (this->attachMirror()) {
+						this->resetStatus = resetStatuses::PGM_ENTRY;
+					} else {
+						// Copy MISO to MOSI for approx. 500ms => TR into programming mode
+						this->mirror(500000UL);
+						this->finishProgramEntry();
+					}
+				} else {
+					this->resetStatus = resetStatuses::RESET_DONE;
+				}
+			}
+			break;
+		case resetStatuses::PGM_ENTRY:
+			// MISO is copied to MOSI in interrupt for approx. 500ms => TR into programming mode
+			if (elapsedUs >= 500000UL) {
+				this->detachMirror();
+				this->finishProgramEntry();
+			}
+			break;
 	}
 }
 
+/**
+ * Finish MISO to MOSI mirroring, TR module must confirm programming mode by SPI status
+ */
+void IQRFTR::finishProgramEntry() {
+	this->iqSpi->resume();
+	this->iqSpi->begin();
+	this->resetStatus = resetStatuses::RESET_DONE;
+	this->programEntryMs = millis();
+	this->programEntry = programEntryStatuses::PGM_ENTRY_VERIFY;
+}
+
+/**
+ * Verify programming mode SPI status after programming mode entry, it is called from driver when SPI is available
+ */
+void IQRFTR::programEntryTask() {
+	if (this->programEntry != programEntryStatuses::PGM_ENTRY_VERIFY) {
+		return;
+	}
+	if (this->spi->getStatus() == this->spi->statuses::PROGRAMMING_MODE) {
+		this->programEntry = programEntryStatuses::PGM_ENTRY_DONE;
+	} else if (millis() - this->programEntryMs >= PGM_ENTRY_TIMEOUT) {
+		this->programEntry = programEntryStatuses::PGM_ENTRY_FAILED;
+	}
+}
+
+/**
+ * Get result of last programming mode entry
+ * @return Programming mode entry status (see IQRFTR::programEntryStatuses)
+ */
+uint8_t IQRFTR::getProgramEntryStatus() {
+	return this->programEntry;
+}
+
+/**
+ * Start copying of MISO to MOSI in interrupt on MISO change
+ * Pin change interrupt is used on AVR if PGM_MIRROR_PCINT is enabled, external interrupt
+ * of MISO pin elsewhere (all pins of SAM and Teensy have one)
+ * @return Interrupt is used, false if MISO must be copied by mirror()
+ */
+bool IQRFTR::attachMirror() {
+#if defined(__AVR__) && PGM_MIRROR_PCINT
+	mirrorMiso();
+	*digitalPinToPCMSK(TR_MISO_PIN) |= _BV(digitalPinToPCMSKbit(TR_MISO_PIN));
+	PCIFR = _BV(digitalPinToPCICRbit(TR_MISO_PIN));
+	*digitalPinToPCICR(TR_MISO_PIN) |= _BV(digitalPinToPCICRbit(TR_MISO_PIN));
+	return true;
+#elif defined(digitalPinToInterrupt) && defined(NOT_AN_INTERRUPT)
+	if (digitalPinToInterrupt(TR_MISO_PIN) != NOT_AN_INTERRUPT) {
+		mirrorMiso();
+		attachInterrupt(digitalPinToInterrupt(TR_MISO_PIN), mirrorMiso, CHANGE);
+		return true;
+	}
+#endif
+	return false;
+}
+
+/**
+ * Stop copying of MISO to MOSI started by attachMirror()
+ */
+void IQRFTR::detachMirror() {
+#if defined(__AVR__) && PGM_MIRROR_PCINT
+	*digitalPinToPCICR(TR_MISO_PIN) &= ~_BV(digitalPinToPCICRbit(TR_MISO_PIN));
+	*digitalPinToPCMSK(TR_MISO_PIN) &= ~_BV(digitalPinToPCMSKbit(TR_MISO_PIN));
+#elif defined(digitalPinToInterrupt) && defined(NOT_AN_INTERRUPT)
+	detachInterrupt(digitalPinToInterrupt(TR_MISO_PIN));
+#endif
+}
+
+/**
+ * Copy MISO to MOSI for given time in busy loop, port registers are used on AVR
+ * @param us Time of mirroring in us
+ */
+void IQRFTR::mirror(unsigned long us) {
+	unsigned long startUs = micros();
+#if defined(__AVR__)
+	volatile uint8_t *misoIn = portInputRegister(digitalPinToPort(TR_MISO_PIN));
+	uint8_t misoMask = digitalPinToBitMask(TR_MISO_PIN);
+	volatile uint8_t *mosiOut = portOutputRegister(digitalPinToPort(TR_MOSI_PIN));
+	uint8_t mosiMask = digitalPinToBitMask(TR_MOSI_PIN);
+	do {
+		uint8_t sreg = SREG;
+		cli();
+		if (*misoIn & misoMask) {
+			*mosiOut |= mosiMask;
+		} else {
+			*mosiOut &= ~mosiMask;
+		}
+		SREG = sreg;
+	} while ((micros() - startUs) < us);
+#else
+	do {
+		mirrorMiso();
+	} while ((micros() - startUs) < us);
+#endif
+}
+
 /**
  * Enter TR module into ON state
  */
 void IQRFTR::turnOn() {
-	pinMode(TR_SS_PIN, OUTPUT);
-	pinMode(TR_RESET_PIN, OUTPUT);
-	digitalWrite(TR_SS_PIN, HIGH);
-	digitalWrite(TR_RESET_PIN, LOW);
+	pinMode(this->iqSpi->getSsPin(), OUTPUT);
+	pinMode(this->resetPin, OUTPUT);
+	digitalWrite(this->iqSpi->getSsPin(), HIGH);
+	digitalWrite(this->resetPin, LOW);
 }
 
 /**
  * Enter TR module into OFF state
  */
 void IQRFTR::turnOff() {
-	pinMode(TR_SS_PIN, OUTPUT);
-	pinMode(TR_RESET_PIN, OUTPUT);
-	digitalWrite(TR_SS_PIN, LOW);
-	digitalWrite(TR_RESET_PIN, HIGH);
+	pinMode(this->iqSpi->getSsPin(), OUTPUT);
+	pinMode(this->resetPin, OUTPUT);
+	digitalWrite(this->iqSpi->getSsPin(), LOW);
+	digitalWrite(this->resetPin, HIGH);
+}
+
+/**
+ * Set TR reset pin
+ * @param pin TR reset pin
+ */
+void IQRFTR::setResetPin(uint8_t pin) {
+	this->resetPin = pin;
+}
+
+/**
+ * Get TR reset pin
+ * @return TR reset pin
+ */
+uint8_t IQRFTR::getResetPin() {
+	return this->resetPin;
 }
 
 /**
@@ -123,25 +311,24 @@ bool IQRFTR::getProgramFlag() {
  * Make TR module reset or switch to prog mode when SPI master is disabled
  */
 void IQRFTR::controlTask() {
-	static unsigned long timeoutMs;
 	switch (this->getControlStatus()) {
 		case controlStatuses::READY:
-			spi->setStatus(spi->statuses::DISABLED);
+			this->spi->setStatus(this->spi->statuses::DISABLED);
 			this->disableProgramFlag();
 			break;
 		case controlStatuses::RESET:
-			spi->setStatus(spi->statuses::BUSY);
-			iqSpi->end();
+			this->spi->setStatus(this->spi->statuses::BUSY);
+			this->iqSpi->end();
 			this->turnOff();
-			timeoutMs = millis();
+			this->controlTimeoutMs = millis();
 			this->setControlStatus(controlStatuses::WAIT);
 			break;
 		case controlStatuses::WAIT:
-			spi->setStatus(spi->statuses::BUSY);
-			if (millis() - timeoutMs >= MILLI_SECOND / 3) {
+			this->spi->setStatus(this->spi->statuses::BUSY);
+			if (millis() - this->controlTimeoutMs >= MILLI_SECOND / 3) {
 				this->setControlStatus(controlStatuses::PROG_MODE);
 			} else {
-				iqSpi->begin();
+				this->iqSpi->begin();
 				this->setControlStatus(controlStatuses::READY);
 			}
 			break;
@@ -168,17 +355,57 @@ uint8_t IQRFTR::getInfoReadingStatus() {
 	return this->infoReading;
 }
 
-void IQRFTR::identify() {
+/**
+ * Process identification data from TR module
+ * @param data Identification data
+ */
+void IQRFTR::identify(const uint8_t *data) {
+	this->restoreInfo(data);
 	// TR info data processed
 	this->infoReading--;
 }
 
+/**
+ * Fill TR module info from cached identification data
+ * @param data Identification data
+ */
+void IQRFTR::restoreInfo(const uint8_t *data) {
+	memcpy(this->info.moduleInfoRawData, data, 8);
+	this->info.moduleId = (uint32_t) data[0] << 24 | (uint32_t) data[1] << 16 | (uint32_t) data[2] << 8 | data[3];
+	this->info.osVersion = (uint16_t) (data[4] / 16) << 8 | (data[4] % 16);
+	this->info.mcuType = data[5] & 0x07;
+	this->info.fcc = (data[5] & 0x08) >> 3;
+	this->info.moduleType = data[5] >> 4;
+	this->info.osBuild = (uint16_t) data[7] << 8 | data[6];
+}
+
+/**
+ * Verify cached TR module info by identification data read in communication mode
+ * @param data Identification data
+ * @return Module ID matches cached info, TR info data are processed
+ */
+bool IQRFTR::verifyInfo(const uint8_t *data) {
+	if (memcmp(this->info.moduleInfoRawData, data, 4) != 0) {
+		return false;
+	}
+	this->infoReading--;
+	return true;
+}
+
+/**
+ * Clear TR module info before reading
+ */
+void IQRFTR::clearInfo() {
+	memset(&this->info, 0, sizeof(this->info));
+	this->info.mcuType = mcuTypes::UNKNOWN;
+}
+
 /**
  * Get OS version
  * @return Version of OS used inside of TR module
  */
 uint16_t IQRFTR::getOsVersion() {
-	return trInfo.osVersion;
+	return this->info.osVersion;
 }
 
 /**
@@ -186,7 +413,7 @@ uint16_t IQRFTR::getOsVersion() {
  * @return Build of OS used inside of TR module
  */
 uint16_t IQRFTR::getOsBuild() {
-	return trInfo.osBuild;
+	return this->info.osBuild;
 }
 
 /**
@@ -194,7 +421,7 @@ uint16_t IQRFTR::getOsBuild() {
  * @return Unique 32 bit identifier data word of TR module
  */
 uint32_t IQRFTR::getModuleId() {
-	return trInfo.moduleId;
+	return this->info.moduleId;
 }
 
 /**
@@ -209,7 +436,7 @@ uint32_t IQRFTR::getModuleId() {
  *   4  | PIC16LF1938
  */
 uint16_t IQRFTR::getMcuType() {
-	return trInfo.mcuType;
+	return this->info.mcuType;
 }
 
 /**
@@ -225,7 +452,7 @@ uint16_t IQRFTR::getMcuType() {
  *  10  |   TR_56D
  */
 uint16_t IQRFTR::getModuleType() {
-	return trInfo.moduleType;
+	return this->info.moduleType;
 }
 
 /**
@@ -233,7 +460,7 @@ uint16_t IQRFTR::getModuleType() {
  * @return FCC (Federal Communications Commission) certification status
  */
 uint16_t IQRFTR::getFccStatus() {
-	return trInfo.fcc;
+	return this->info.fcc;
 }
 
 /**
@@ -242,5 +469,13 @@ uint16_t IQRFTR::getFccStatus() {
  * @return Data byte from info raw buffer
  */
 uint8_t IQRFTR::getRawInfoData(uint8_t position) {
-	return trInfo.moduleInfoRawData[position];
+	return this->info.moduleInfoRawData[position];
+}
+
+/**
+ * Get raw info data about TR module
+ * @return 8 B of identification data
+ */
+const uint8_t* IQRFTR::getRawInfoData() {
+	return this->info.moduleInfoRawData;
 }
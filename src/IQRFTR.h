@@ -32,15 +32,35 @@
 #include "IQRFSPI.h"
 #include "IQSPI.h"
 
+/**
+ * TR module info structure
+ */
+typedef struct {
+	uint16_t osVersion; //!< OS version
+	uint16_t osBuild; //!< OS build
+	uint32_t moduleId; //!< Module ID
+	uint16_t mcuType; //!< MCU tyle
+	uint16_t moduleType; //!< Module type
+	uint16_t fcc; //!< FCC
+	uint8_t moduleInfoRawData[8]; //!< Raw data
+} trInfo_t;
+
 /**
  * IQRF TR
  */
 class IQRFTR {
 public:
+	void begin(IQRFSPI *spi, IQSPI *iqSpi);
 	void reset();
 	void enterProgramMode();
+	bool isResetting();
+	void resetTask();
+	void programEntryTask();
+	uint8_t getProgramEntryStatus();
 	void turnOn();
 	void turnOff();
+	void setResetPin(uint8_t pin);
+	uint8_t getResetPin();
 	uint8_t getControlStatus();
 	void setControlStatus(uint8_t status);
 	void enableProgramFlag();
@@ -49,7 +69,10 @@ public:
 	void controlTask();
 	void setInfoReadingStatus(uint8_t status);
 	uint8_t getInfoReadingStatus();
-	void identify();
+	void identify(const uint8_t *data);
+	void restoreInfo(const uint8_t *data);
+	bool verifyInfo(const uint8_t *data);
+	void clearInfo();
 	uint16_t getOsVersion();
 	uint16_t getOsBuild();
 	uint32_t getModuleId();
@@ -57,6 +80,7 @@ public:
 	uint16_t getModuleType();
 	uint16_t getFccStatus();
 	uint8_t getRawInfoData(uint8_t position);
+	const uint8_t* getRawInfoData();
 
 	/**
 	 * TR control statuses
@@ -68,6 +92,27 @@ public:
 		PROG_MODE = 3 //!< TR programming mode
 	};
 
+	/**
+	 * TR reset statuses
+	 */
+	enum resetStatuses {
+		RESET_DONE = 0, //!< No reset in progress
+		POWER_OFF = 1, //!< TR module is powered off
+		POWER_ON = 2, //!< TR module starts after power on
+		PGM_ENTRY = 3 //!< MISO is copied to MOSI to enter programming mode
+	};
+
+	/**
+	 * Results of programming mode entry
+	 */
+	enum programEntryStatuses {
+		PGM_ENTRY_NONE = 0, //!< Programming mode entry was not started
+		PGM_ENTRY_PENDING = 1, //!< TR module is reset and MISO is copied to MOSI
+		PGM_ENTRY_VERIFY = 2, //!< Programming mode SPI status is awaited
+		PGM_ENTRY_DONE = 3, //!< TR module reported programming mode
+		PGM_ENTRY_FAILED = 4 //!< TR module did not report programming mode
+	};
+
 	/**
 	 * TR module types
 	 */
@@ -101,16 +146,36 @@ public:
 		CERTIFIED = 1 //!< Certified by FCC
 	};
 private:
+	void finishProgramEntry();
+	bool attachMirror();
+	void detachMirror();
+	void mirror(unsigned long us);
 	/// TR info reading status
 	uint8_t infoReading;
 	/// TR control status
 	uint8_t controlStatus;
 	/// TR programming flag
 	bool programFlag;
-	/// Instance of IQRFSPI class
-	IQRFSPI* spi = new IQRFSPI;
-	/// Instance of IQSPI class
-	IQSPI* iqSpi = new IQSPI;
+	/// Timeout timer of control task in ms
+	unsigned long controlTimeoutMs;
+	/// TR reset status
+	uint8_t resetStatus;
+	/// Start of actual reset step in us
+	unsigned long resetStartUs;
+	/// Programming mode is entered after reset
+	bool programAfterReset;
+	/// Result of programming mode entry
+	uint8_t programEntry = programEntryStatuses::PGM_ENTRY_NONE;
+	/// Start of programming mode SPI status verification in ms
+	unsigned long programEntryMs;
+	/// TR module info
+	trInfo_t info;
+	/// TR reset pin
+	uint8_t resetPin = TR_RESET_PIN;
+	/// IQRF SPI of driver
+	IQRFSPI *spi;
+	/// SPI interface of driver
+	IQSPI *iqSpi;
 };
 
 #endif
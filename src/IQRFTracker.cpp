@@ -0,0 +1,173 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "IQRFTracker.h"
+
+/**
+ * Initialize empty tracker
+ */
+void IQRFTracker::begin() {
+	memset(this->records, 0, sizeof(this->records));
+	this->recordIndex = 0;
+	this->resetCounters();
+}
+
+/**
+ * Record completed Tx packet
+ * @param packetId Packet ID
+ * @param result Tx result (see IQRFPackets::statuses)
+ * @param queuedUs Enqueue time in us
+ * @param startUs Start of the first transfer in us
+ * @param doneUs Completion time in us
+ */
+void IQRFTracker::record(uint8_t packetId, uint8_t result, unsigned long queuedUs, unsigned long startUs, unsigned long doneUs) {
+	packetTimes_t *times = &this->records[this->recordIndex];
+	times->packetId = packetId;
+	times->result = result;
+	times->queuedUs = queuedUs;
+	times->startUs = startUs;
+	times->doneUs = doneUs;
+	if (++this->recordIndex >= TRACKER_RECORDS) {
+		this->recordIndex = 0;
+	}
+	unsigned long latency = doneUs - queuedUs;
+	// bucket 0 for latencies below 512 us, each next bucket has double limit
+	uint8_t bucket = 0;
+	for (unsigned long limit = latency >> 9; limit && bucket < TRACKER_BUCKETS - 1; limit >>= 1) {
+		bucket++;
+	}
+	if (this->histogram[bucket] < 0xFFFF) {
+		this->histogram[bucket]++;
+	}
+	this->packetCounter++;
+	this->queueTimeSum += startUs - queuedUs;
+	this->transferTimeSum += doneUs - startUs;
+	if (latency > this->latencyMax) {
+		this->latencyMax = latency;
+	}
+}
+
+/**
+ * Find timestamps of recently completed Tx packet
+ * @param packetId Packet ID
+ * @param times Timestamps of the packet
+ * @return Packet was found
+ */
+bool IQRFTracker::find(uint8_t packetId, packetTimes_t *times) {
+	if (packetId == 0) {
+		return false;
+	}
+	// the newest record first, packet IDs are reused
+	uint8_t index = this->recordIndex;
+	for (uint8_t i = 0; i < TRACKER_RECORDS; i++) {
+		index = index ? index - 1 : TRACKER_RECORDS - 1;
+		if (this->records[index].packetId == packetId) {
+			memcpy(times, &this->records[index], sizeof(packetTimes_t));
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Get latency of recently completed Tx packet
+ * @param packetId Packet ID
+ * @return Latency from enqueue to completion in us, 0 if the packet was not found
+ */
+unsigned long IQRFTracker::getLatency(uint8_t packetId) {
+	packetTimes_t times;
+	if (!this->find(packetId, &times)) {
+		return 0;
+	}
+	return times.doneUs - times.queuedUs;
+}
+
+/**
+ * Get count of packets in histogram bucket
+ * @param bucket Bucket index
+ * @return Count of packets with latency in the bucket
+ */
+uint16_t IQRFTracker::getHistogram(uint8_t bucket) {
+	if (bucket >= TRACKER_BUCKETS) {
+		return 0;
+	}
+	return this->histogram[bucket];
+}
+
+/**
+ * Get upper limit of histogram bucket, the last bucket has no limit
+ * @param bucket Bucket index
+ * @return Upper limit of latencies in the bucket in us
+ */
+unsigned long IQRFTracker::getBucketLimit(uint8_t bucket) {
+	return 512UL << bucket;
+}
+
+/**
+ * Get count of completed packets
+ * @return Count of completed packets
+ */
+unsigned long IQRFTracker::getPacketCount() {
+	return this->packetCounter;
+}
+
+/**
+ * Get average time of packets in Tx queue
+ * @return Average time from enqueue to the first transfer in us
+ */
+unsigned long IQRFTracker::getAverageQueueTime() {
+	if (this->packetCounter == 0) {
+		return 0;
+	}
+	return this->queueTimeSum / this->packetCounter;
+}
+
+/**
+ * Get average transfer time of packets including retries
+ * @return Average time from the first transfer to completion in us
+ */
+unsigned long IQRFTracker::getAverageTransferTime() {
+	if (this->packetCounter == 0) {
+		return 0;
+	}
+	return this->transferTimeSum / this->packetCounter;
+}
+
+/**
+ * Get maximal latency of packets
+ * @return Maximal latency from enqueue to completion in us
+ */
+unsigned long IQRFTracker::getMaxLatency() {
+	return this->latencyMax;
+}
+
+/**
+ * Reset histogram and latency counters, records of packets are kept
+ */
+void IQRFTracker::resetCounters() {
+	memset(this->histogram, 0, sizeof(this->histogram));
+	this->packetCounter = 0;
+	this->queueTimeSum = 0;
+	this->transferTimeSum = 0;
+	this->latencyMax = 0;
+}
\ No newline at end of file
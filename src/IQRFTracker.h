@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFTRACKER_H
+#define IQRFTRACKER_H
+
+#include <stdint.h>
+
+#include "IQRFSettings.h"
+
+/**
+ * Timestamps of one Tx packet
+ */
+typedef struct {
+	uint8_t packetId; //!< Packet ID, 0 for empty record
+	uint8_t result; //!< Tx result (see IQRFPackets::statuses)
+	unsigned long queuedUs; //!< Enqueue time in us
+	unsigned long startUs; //!< Start of the first transfer in us, equal to doneUs for packets which were not sent
+	unsigned long doneUs; //!< Completion time in us
+} packetTimes_t;
+
+/**
+ * Tracker of Tx packets, it keeps timestamps of last completed packets
+ * and histogram of latencies from enqueue to completion
+ */
+class IQRFTracker {
+public:
+	void begin();
+	void record(uint8_t packetId, uint8_t result, unsigned long queuedUs, unsigned long startUs, unsigned long doneUs);
+	bool find(uint8_t packetId, packetTimes_t *times);
+	unsigned long getLatency(uint8_t packetId);
+	uint16_t getHistogram(uint8_t bucket);
+	unsigned long getBucketLimit(uint8_t bucket);
+	unsigned long getPacketCount();
+	unsigned long getAverageQueueTime();
+	unsigned long getAverageTransferTime();
+	unsigned long getMaxLatency();
+	void resetCounters();
+private:
+	/// Timestamps of last completed packets
+	packetTimes_t records[TRACKER_RECORDS];
+	/// Index of next written record
+	uint8_t recordIndex;
+	/// Histogram of latencies, bucket N counts latencies below 2^(N + 9) us
+	uint16_t histogram[TRACKER_BUCKETS];
+	/// Count of completed packets
+	unsigned long packetCounter;
+	/// Sum of times in Tx queue in us
+	unsigned long queueTimeSum;
+	/// Sum of times from the first transfer to completion in us
+	unsigned long transferTimeSum;
+	/// Maximal latency in us
+	unsigned long latencyMax;
+};
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "IQRFTxQueue.h"
+
+/**
+ * Initialize empty Tx queue
+ * @param buffer Tx packet buffer
+ * @param capacity Capacity of Tx packet buffer
+ * @param arena Packet data arena
+ * @param arenaSize Size of packet data arena
+ */
+void IQRFTxQueue::begin(packetBuffer_t *buffer, uint8_t capacity, uint8_t *arena, uint16_t arenaSize) {
+	this->buffer = buffer;
+	this->capacity = capacity;
+	this->arena = arena;
+	this->arenaSize = arenaSize;
+	this->arenaInPtr = 0;
+	this->inPtr = 0;
+	this->outPtr = 0;
+	this->count = 0;
+	this->highWaterMark = 0;
+	this->overflowCounter = 0;
+	this->overflowPolicy = overflowPolicies::REJECT;
+	this->blockTimeout = 0;
+	this->weight = 0;
+}
+
+/**
+ * Find place for packet data in arena, data of one packet are stored contiguously
+ * @param dataLength Data length
+ * @return Offset of data in arena or arena size if there is no place
+ */
+uint16_t IQRFTxQueue::allocate(uint8_t dataLength) {
+	if (this->isEmpty()) {
+		this->arenaInPtr = 0;
+		return (dataLength <= this->arenaSize) ? 0 : this->arenaSize;
+	}
+	uint16_t arenaOutPtr = this->buffer[this->outPtr].dataOffset;
+	if (this->arenaInPtr > arenaOutPtr) {
+		// free space at the end of arena or wrap around to the beginning
+		if (dataLength <= this->arenaSize - this->arenaInPtr) {
+			return this->arenaInPtr;
+		}
+		if (dataLength <= arenaOutPtr) {
+			return 0;
+		}
+	} else if (dataLength <= arenaOutPtr - this->arenaInPtr) {
+		// free space between the newest and the oldest packet
+		return this->arenaInPtr;
+	}
+	return this->arenaSize;
+}
+
+/**
+ * Check if packet fits into Tx queue
+ * @param dataLength Data length
+ * @return Packet fits into Tx queue
+ */
+bool IQRFTxQueue::canPush(uint8_t dataLength) {
+	return !this->isFull() && this->allocate(dataLength) != this->arenaSize;
+}
+
+/**
+ * Copy packet to the end of Tx queue
+ * @param packetId Packet ID
+ * @param spiCmd SPI command
+ * @param dataBuffer Pointer to data buffer, data are copied to arena
+ * @param dataLength Data length
+ * @param dataCrc Data folded by IQRFCRC::fold()
+ * @param retryPolicy Retry policy or NULL for retry policy of the driver
+ * @param timestamp Enqueue time in us
+ * @return Packet was queued
+ */
+bool IQRFTxQueue::push(uint8_t packetId, uint8_t spiCmd, const uint8_t *dataBuffer, uint8_t dataLength, uint8_t dataCrc, IQRFRetryPolicy *retryPolicy, unsigned long timestamp) {
+	if (this->isFull()) {
+		return false;
+	}
+	uint16_t dataOffset = this->allocate(dataLength);
+	if (dataOffset == this->arenaSize) {
+		return false;
+	}
+	memcpy(&this->arena[dataOffset], dataBuffer, dataLength);
+	this->arenaInPtr = dataOffset + dataLength;
+	this->buffer[this->inPtr].packetId = packetId;
+	this->buffer[this->inPtr].spiCmd = spiCmd;
+	this->buffer[this->inPtr].dataOffset = dataOffset;
+	this->buffer[this->inPtr].dataLength = dataLength;
+	this->buffer[this->inPtr].dataCrc = dataCrc;
+	this->buffer[this->inPtr].retryPolicy = retryPolicy;
+	this->buffer[this->inPtr].timestamp = timestamp;
+	this->buffer[this->inPtr].attempts = 0;
+	if (++this->inPtr >= this->capacity) {
+		this->inPtr = 0;
+	}
+	if (++this->count > this->highWaterMark) {
+		this->highWaterMark = this->count;
+	}
+	return true;
+}
+
+/**
+ * Get the oldest packet in Tx queue
+ * @return Pointer to the oldest packet or NULL if Tx queue is empty
+ */
+packetBuffer_t* IQRFTxQueue::front() {
+	if (this->isEmpty()) {
+		return NULL;
+	}
+	return &this->buffer[this->outPtr];
+}
+
+/**
+ * Get packet data stored in arena
+ * @param packet Pointer to packet
+ * @return Pointer to packet data
+ */
+uint8_t* IQRFTxQueue::getData(packetBuffer_t *packet) {
+	return &this->arena[packet->dataOffset];
+}
+
+/**
+ * Remove the oldest packet from Tx queue
+ */
+void IQRFTxQueue::pop() {
+	if (this->isEmpty()) {
+		return;
+	}
+	if (++this->outPtr >= this->capacity) {
+		this->outPtr = 0;
+	}
+	this->count--;
+}
+
+/**
+ * Check if Tx queue is empty
+ * @return Tx queue is empty
+ */
+bool IQRFTxQueue::isEmpty() {
+	return this->count == 0;
+}
+
+/**
+ * Check if Tx queue is full
+ * @return Tx queue is full
+ */
+bool IQRFTxQueue::isFull() {
+	return this->count >= this->capacity;
+}
+
+/**
+ * Get capacity of Tx queue
+ * @return Capacity of Tx queue
+ */
+uint8_t IQRFTxQueue::getCapacity() {
+	return this->capacity;
+}
+
+/**
+ * Get count of packets in Tx queue
+ * @return Count of packets in Tx queue
+ */
+uint8_t IQRFTxQueue::getCount() {
+	return this->count;
+}
+
+/**
+ * Get count of free slots in Tx queue
+ * @return Count of free slots in Tx queue
+ */
+uint8_t IQRFTxQueue::getFreeSlots() {
+	return this->capacity - this->count;
+}
+
+/**
+ * Get count of free bytes in arena, some of them may be unusable due to wrap around
+ * @return Count of free bytes in arena
+ */
+uint16_t IQRFTxQueue::getFreeBytes() {
+	if (this->isEmpty()) {
+		return this->arenaSize;
+	}
+	uint16_t arenaOutPtr = this->buffer[this->outPtr].dataOffset;
+	if (this->arenaInPtr > arenaOutPtr) {
+		return this->arenaSize - this->arenaInPtr + arenaOutPtr;
+	}
+	return arenaOutPtr - this->arenaInPtr;
+}
+
+/**
+ * Get maximal count of packets in Tx queue
+ * @return Maximal count of packets in Tx queue
+ */
+uint8_t IQRFTxQueue::getHighWaterMark() {
+	return this->highWaterMark;
+}
+
+/**
+ * Reset maximal count of packets in Tx queue
+ */
+void IQRFTxQueue::resetHighWaterMark() {
+	this->highWaterMark = this->count;
+}
+
+/**
+ * Set behaviour of full Tx queue
+ * @param policy Overflow policy
+ * @param timeout Timeout of blocking overflow policy in ms
+ */
+void IQRFTxQueue::setOverflowPolicy(uint8_t policy, unsigned long timeout) {
+	this->overflowPolicy = policy;
+	this->blockTimeout = timeout;
+}
+
+/**
+ * Get behaviour of full Tx queue
+ * @return Overflow policy
+ */
+uint8_t IQRFTxQueue::getOverflowPolicy() {
+	return this->overflowPolicy;
+}
+
+/**
+ * Get timeout of blocking overflow policy
+ * @return Timeout in ms
+ */
+unsigned long IQRFTxQueue::getBlockTimeout() {
+	return this->blockTimeout;
+}
+
+/**
+ * Count rejected or dropped packet
+ */
+void IQRFTxQueue::overflow() {
+	this->overflowCounter++;
+}
+
+/**
+ * Get count of rejected or dropped packets
+ * @return Count of rejected or dropped packets
+ */
+unsigned long IQRFTxQueue::getOverflowCount() {
+	return this->overflowCounter;
+}
+
+/**
+ * Set count of packets sent in a row while lower priority queue waits
+ * @param weight Count of packets, 0 means strict priority
+ */
+void IQRFTxQueue::setWeight(uint8_t weight) {
+	this->weight = weight;
+}
+
+/**
+ * Get count of packets sent in a row while lower priority queue waits
+ * @return Count of packets, 0 means strict priority
+ */
+uint8_t IQRFTxQueue::getWeight() {
+	return this->weight;
+}
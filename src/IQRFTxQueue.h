@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @author Rostislav Špinar <rostislav.spinar@microrisc.com>
+ * @author Roman Ondráček <ondracek.roman@centrum.cz>
+ * @version 1.1
+ *
+ * Copyright 2015-2016 MICRORISC s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IQRFTXQUEUE_H
+#define IQRFTXQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "IQRFRetryPolicy.h"
+#include "IQRFSettings.h"
+
+/**
+ * Item of SPI TX packet buffer
+ */
+typedef struct {
+	unsigned long timestamp; //!< Enqueue time in us
+	IQRFRetryPolicy *retryPolicy; //!< Retry policy or NULL for retry policy of the driver
+	unsigned long startUs; //!< Start of the first transfer in us, valid if attempts is not 0
+	uint16_t dataOffset; //!< Offset of data in packet arena
+	uint8_t packetId; //!< Packet ID
+	uint8_t spiCmd; //!< SPI command
+	uint8_t dataLength; //!< Data lenght
+	uint8_t dataCrc; //!< Data folded for CRCM
+	uint8_t attempts; //!< Remaining attempts of packet aborted by not ready TR module or 0 if not started
+} packetBuffer_t;
+
+/**
+ * Bounded queue of SPI TX packets, packet data are copied to the fixed size arena
+ */
+class IQRFTxQueue {
+public:
+	void begin(packetBuffer_t *buffer, uint8_t capacity, uint8_t *arena, uint16_t arenaSize);
+	bool canPush(uint8_t dataLength);
+	bool push(uint8_t packetId, uint8_t spiCmd, const uint8_t *dataBuffer, uint8_t dataLength, uint8_t dataCrc, IQRFRetryPolicy *retryPolicy, unsigned long timestamp);
+	packetBuffer_t* front();
+	uint8_t* getData(packetBuffer_t *packet);
+	void pop();
+	bool isEmpty();
+	bool isFull();
+	uint8_t getCapacity();
+	uint8_t getCount();
+	uint8_t getFreeSlots();
+	uint16_t getFreeBytes();
+	uint8_t getHighWaterMark();
+	void resetHighWaterMark();
+	void setOverflowPolicy(uint8_t policy, unsigned long timeout);
+	uint8_t getOverflowPolicy();
+	unsigned long getBlockTimeout();
+	void overflow();
+	unsigned long getOverflowCount();
+	void setWeight(uint8_t weight);
+	uint8_t getWeight();
+
+	/**
+	 * Behaviour of full Tx queue
+	 */
+	enum overflowPolicies {
+		REJECT = 0, //!< New packet is rejected
+		BLOCK = 1, //!< Wait for free slot until timeout, then reject new packet
+		DROP_OLDEST = 2 //!< Oldest packet is dropped
+	};
+private:
+	uint16_t allocate(uint8_t dataLength);
+	/// Tx packet buffer
+	packetBuffer_t *buffer;
+	/// Capacity of Tx packet buffer
+	uint8_t capacity;
+	/// Packet data arena
+	uint8_t *arena;
+	/// Size of packet data arena
+	uint16_t arenaSize;
+	/// Arena input offset
+	uint16_t arenaInPtr;
+	/// Packet input pointer
+	uint8_t inPtr;
+	/// Packet output pointer
+	uint8_t outPtr;
+	/// Count of packets in queue
+	uint8_t count;
+	/// Maximal count of packets in queue
+	uint8_t highWaterMark;
+	/// Overflow policy
+	uint8_t overflowPolicy;
+	/// Timeout of blocking overflow policy in ms
+	unsigned long blockTimeout;
+	/// Count of rejected or dropped packets
+	unsigned long overflowCounter;
+	/// Count of packets sent in a row while lower priority queue waits
+	uint8_t weight;
+};
+
+#endif
@@ -25,12 +25,12 @@
  * Initialize the SPI bus
  */
 void IQSPI::begin() {
-	pinMode(TR_SS_PIN, OUTPUT);
-	digitalWrite(TR_SS_PIN, HIGH);
+	pinMode(this->ssPin, OUTPUT);
+	digitalWrite(this->ssPin, HIGH);
 #if defined(__PIC32MX__)
 	spi.begin();
 	spi.setSpeed(IQSPI_CLOCK);
-	spi.setPinSelect(TR_SS_PIN);
+	spi.setPinSelect(this->ssPin);
 #else
 	SPI.begin();
 #endif
@@ -38,8 +38,14 @@ void IQSPI::begin() {
 
 /**
  * Disable the SPI bud
+ * On a shared bus only SS of this TR module is released, SPI peripheral stays enabled for other TR modules
  */
 void IQSPI::end() {
+	if (this->shared) {
+		pinMode(this->ssPin, OUTPUT);
+		digitalWrite(this->ssPin, HIGH);
+		return;
+	}
 #if defined(__PIC32MX__)
 	spi.end();
 #else
@@ -47,6 +53,61 @@ void IQSPI::end() {
 #endif
 }
 
+/**
+ * Disable SPI peripheral, so MOSI pin can be driven as GPIO during MISO to MOSI mirroring
+ * SPI unit of AVR overrides MOSI port value in master mode. SPI.end() of AVR only counts down
+ * SPI.begin() calls of all TR modules on the bus, so the SPI unit is disabled directly
+ * Other TR modules must not use the bus until resume()
+ */
+void IQSPI::suspend() {
+#if defined(__PIC32MX__)
+	spi.end();
+#elif defined(__AVR__)
+	SPCR &= ~_BV(SPE);
+#else
+	SPI.end();
+#endif
+}
+
+/**
+ * Enable SPI peripheral disabled by suspend()
+ */
+void IQSPI::resume() {
+#if defined(__PIC32MX__)
+	spi.begin();
+	spi.setSpeed(IQSPI_CLOCK);
+	spi.setPinSelect(this->ssPin);
+#elif defined(__AVR__)
+	SPCR |= _BV(SPE);
+#else
+	SPI.begin();
+#endif
+}
+
+/**
+ * Set if SPI bus is shared with other TR modules, called by IQRFBase::setBus()
+ * @param shared SPI bus is shared
+ */
+void IQSPI::setShared(bool shared) {
+	this->shared = shared;
+}
+
+/**
+ * Set SPI SS pin, more TR modules can share SPI bus with different SS pins
+ * @param pin SPI SS pin of TR module
+ */
+void IQSPI::setSsPin(uint8_t pin) {
+	this->ssPin = pin;
+}
+
+/**
+ * Get SPI SS pin
+ * @return SPI SS pin of TR module
+ */
+uint8_t IQSPI::getSsPin() {
+	return this->ssPin;
+}
+
 /**
  * SPI byte transfer
  * @param txByte Transmitted byte
@@ -61,14 +122,65 @@ uint8_t IQSPI::transfer(uint8_t txByte) {
 	delayMicroseconds(10);
 	spi.setSelect(HIGH);
 #else
-	pinMode(TR_SS_PIN, OUTPUT);
-	digitalWrite(TR_SS_PIN, LOW);
+	pinMode(this->ssPin, OUTPUT);
+	digitalWrite(this->ssPin, LOW);
 	delayMicroseconds(10);
 	SPI.beginTransaction(SPISettings(IQSPI_CLOCK, MSBFIRST, SPI_MODE0));
 	rxByte = SPI.transfer(txByte);
 	SPI.endTransaction();
 	delayMicroseconds(10);
-	digitalWrite(TR_SS_PIN, HIGH);
+	digitalWrite(this->ssPin, HIGH);
 #endif
 	return rxByte;
+}
+
+/**
+ * SPI block transfer, SS is asserted and SPI bus is configured once per block
+ * Fixed SS setup and hold delays (2 x 10 us) are spent once per block instead of once per byte
+ * @param txBuffer Transmitted bytes
+ * @param rxBuffer Received bytes
+ * @param length Number of bytes
+ * @param gapUs Byte to byte pause in us, measured from start of previous byte
+ * @return XOR of received bytes, it is folded during byte to byte pauses
+ */
+uint8_t IQSPI::transferBlock(const uint8_t *txBuffer, uint8_t *rxBuffer, size_t length, unsigned long gapUs) {
+	unsigned long byteStartUs = 0;
+	uint8_t rxCrc = 0;
+#if defined(__PIC32MX__)
+	spi.setSelect(LOW);
+	delayMicroseconds(10);
+	for (size_t i = 0; i < length; i++) {
+		if (i) {
+			unsigned long elapsedUs = micros() - byteStartUs;
+			if (elapsedUs < gapUs) {
+				delayMicroseconds(gapUs - elapsedUs);
+			}
+		}
+		byteStartUs = micros();
+		spi.transfer(1, txBuffer[i], &rxBuffer[i]);
+		rxCrc ^= rxBuffer[i];
+	}
+	delayMicroseconds(10);
+	spi.setSelect(HIGH);
+#else
+	pinMode(this->ssPin, OUTPUT);
+	digitalWrite(this->ssPin, LOW);
+	delayMicroseconds(10);
+	SPI.beginTransaction(SPISettings(IQSPI_CLOCK, MSBFIRST, SPI_MODE0));
+	for (size_t i = 0; i < length; i++) {
+		if (i) {
+			unsigned long elapsedUs = micros() - byteStartUs;
+			if (elapsedUs < gapUs) {
+				delayMicroseconds(gapUs - elapsedUs);
+			}
+		}
+		byteStartUs = micros();
+		rxBuffer[i] = SPI.transfer(txBuffer[i]);
+		rxCrc ^= rxBuffer[i];
+	}
+	SPI.endTransaction();
+	delayMicroseconds(10);
+	digitalWrite(this->ssPin, HIGH);
+#endif
+	return rxCrc;
 }
\ No newline at end of file
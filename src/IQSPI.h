@@ -31,6 +31,7 @@
 #include <Arduino.h>
 #include <SPI.h>
 #endif
+#include <stddef.h>
 #include <stdint.h>
 
 #include "IQRFSettings.h"
@@ -42,8 +43,18 @@ class IQSPI {
 public:
 	void begin();
 	void end();
+	void suspend();
+	void resume();
+	void setShared(bool shared);
+	void setSsPin(uint8_t pin);
+	uint8_t getSsPin();
 	uint8_t transfer(uint8_t txByte);
+	uint8_t transferBlock(const uint8_t *txBuffer, uint8_t *rxBuffer, size_t length, unsigned long gapUs);
 private:
+	/// SPI SS pin of TR module
+	uint8_t ssPin = TR_SS_PIN;
+	/// SPI bus is shared with other TR modules, end() keeps SPI peripheral enabled
+	bool shared = false;
 #if defined(__PIC32MX__)
 	/// Instance of chipKIT SPI class
 	DSPI0 spi;
@@ -21,330 +21,693 @@
 
 #include "iqrf_library.h"
 
-/*
- * Locally used function prototypes
- */
-void trInfoTask();
-
-/*
- * Public variable declarations
- */
-/// Data length
-uint8_t dataLength;
-/// TR info structure
-trInfo_t trInfo;
-/// IQRF packet buffer
-packetBuffer_t iqrfPacketBuffer[PACKET_BUFFER_SIZE];
-/// Packet input buffer
-uint16_t packetBufferInPtr;
-/// Packet output buffer
-uint16_t packetBufferOutPtr;
 /// Packet to end program mode
 const uint8_t endPgmMode[] = {0xDE, 0x01, 0xFF};
-
-/// Instance of IQRF class
-IQRF _iqrf;
-/// Instance of IQRFBuffers class
-IQRFBuffers _buffers;
-/// Instance of IQRFCRC class
-IQRFCRC _crc;
-/// Instance of IQRFCallbacks class
-IQRFCallbacks _callbacks;
-/// Instance of IQRFPackets class
-IQRFPackets _packets;
-/// Instance of IQRFSPI class
-IQRFSPI _spi;
-/// Instance of IQRFTR class
-IQRFTR _tr;
-/// Instance of IQSPI class
-IQSPI _iqSpi;
+/// Request of TR module info
+const uint8_t infoRequest[16] = {0};
 
 /**
  * Function perform a TR-module driver initialization
- * Function performes initialization of trInfo identification data structure
+ * Function performes initialization of TR module info, it returns when the driver is ready
+ * Driver storage must be attached before, see IQRFStorage
  * @param rxCallback Pointer to callback function. Function is called when the driver receives data from the TR module
- * @param txCallback Pointer to callback function. unction is called when the driver sent data to the TR module
+ * @param rxViewCallback Pointer to callback function or NULL. Function is called with read-only view of received data instead of rxCallback
+ * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
  */
-void IQRF_Init(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback) {
-	_tr.turnOn();
-	_iqSpi.begin();
+void IQRFBase::init(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::rxViewCallback_t rxViewCallback, IQRFCallbacks::txCallback_t txCallback) {
+	this->start(rxCallback, rxViewCallback, txCallback, NULL);
+	// wait for TR module ID reading, other TR modules on the bus are served meanwhile
+	while (!this->ready) {
+		if (!this->driveBus()) {
+			// begin() called from a callback of the bus
+			this->driver();
+		}
+	}
+}
+
+/**
+ * Function starts a TR-module driver initialization, it returns immediately
+ * TR module info is read in following driver() calls, then the driver is ready
+ * Driver storage must be attached before, see IQRFStorage
+ * @param rxCallback Pointer to callback function. Function is called when the driver receives data from the TR module
+ * @param rxViewCallback Pointer to callback function or NULL. Function is called with read-only view of received data instead of rxCallback
+ * @param txCallback Pointer to callback function. Function is called when the driver sent data to the TR module
+ * @param readyCallback Pointer to callback function or NULL. Function is called when the driver is ready
+ */
+void IQRFBase::start(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::rxViewCallback_t rxViewCallback, IQRFCallbacks::txCallback_t txCallback, IQRFCallbacks::readyCallback_t readyCallback) {
+	this->ready = false;
+	this->spi.setMasterStatus(this->spi.masterStatuses::FREE);
+	this->spi.setStatus(this->spi.statuses::DISABLED);
+	this->usCounter0 = 0;
+	this->driverRunning = false;
+	this->txHighInRow = 0;
+	this->txActiveQueue = &this->txQueue;
+	this->retryPolicy = &this->defaultRetryPolicy;
+	this->txRetryPolicy = this->retryPolicy;
+	this->retryBackoff = 0;
+	this->tracker.begin();
+	this->statistics.begin(micros());
+	// normal SPI communication
+	this->spi.disableFastSpi();
+	this->tr.begin(&this->spi, &this->iqSpi);
+	this->tr.turnOn();
+	// application is not notified during TR module info reading
+	this->callbacks.setRxCallback(doNothingRx);
+	this->callbacks.setRxViewCallback(NULL);
+	this->callbacks.setTxCallback(doNothingTx);
+	this->callbacks.setReadyCallback(NULL);
+	this->appCallbacks.setRxCallback(rxCallback);
+	this->appCallbacks.setRxViewCallback(rxViewCallback);
+	this->appCallbacks.setTxCallback(txCallback);
+	this->appCallbacks.setReadyCallback(readyCallback);
+	this->iqSpi.begin();
+	this->polling.begin();
 	// enable SPI master function in driver
-	_spi.enableMaster();
+	this->spi.enableMaster();
 	// read TR module info
-	_tr.setInfoReadingStatus(2);
-	// wait for TR module ID reading
-	while (_tr.getInfoReadingStatus()) {
-		// IQRF SPI communication driver
-		_iqrf.driver();
-		// TR module info reading task
-		trInfoTask();
-	}
+	this->tr.setInfoReadingStatus(2);
+	this->infoTaskStatus = 0;
+	this->started = true;
+}
+
+/**
+ * Finish driver initialization after TR module info is read
+ */
+void IQRFBase::finishInit() {
 	// if TR72D or TR76D is conected
-	if (trInfo.moduleType == _tr.types::TR_72D || trInfo.moduleType == _tr.types::TR_76D) {
-		_spi.enableFastSpi();
-		Serial.println("[IQRF] Enabled Fast SPI");
+	if (this->tr.getModuleType() == this->tr.types::TR_72D || this->tr.getModuleType() == this->tr.types::TR_76D) {
+		this->spi.enableFastSpi();
+		if (this->logEnabled) {
+			Serial.println("[IQRF] Enabled Fast SPI");
+		}
 	}
-	_callbacks.setRxCallback(rxCallback);
-	_callbacks.setTxCallback(txCallback);
-	_tr.setControlStatus(_tr.controlStatuses::READY);
+	// count application traffic only
+	this->statistics.begin(micros());
+	this->tracker.begin();
+	this->callbacks = this->appCallbacks;
+	this->tr.setControlStatus(this->tr.controlStatuses::READY);
+	this->ready = true;
+	this->callbacks.callReadyCallback();
 }
 
 /**
- * Periodically called IQRF_Driver
+ * Periodically called IQRF driver
  */
-void IQRF_Driver() {
-	// SPI Master enabled
-	if (_spi.isMasterEnabled()) {
-		_iqrf.setUsCount1(micros());
-		// is anything to send in Tx buffer?
-		if (_spi.getMasterStatus() != _spi.masterStatuses::FREE) {
-			// send 1 byte every defined time interval via SPI
-			if ((_iqrf.getUsCount1() - _iqrf.getUsCount0()) > _spi.getBytePause()) {
+void IQRFBase::driver() {
+	if (!this->started) {
+		// TR module on a bus waits for its begin()
+		return;
+	}
+	// callbacks and info reading can send packets, BLOCK policy must not enter the driver again
+	this->driverRunning = true;
+	if (this->tr.isResetting()) {
+		// TR module is reset or enters programming mode, SPI is not available
+		this->tr.resetTask();
+	} else if (this->spi.isMasterEnabled()) {
+		// SPI Master enabled
+		unsigned long holdStartUs = micros();
+		// in drain mode continue with next packet while TR module is ready
+		while (this->spiTask() && this->spi.isDrainModeEnabled() && (micros() - holdStartUs) < this->spi.getDrainHoldTime()) {
+			this->waitBytePause();
+		}
+		this->tr.programEntryTask();
+	} else {
+		// SPI master is disabled
+		this->tr.controlTask();
+	}
+	// TR module info is read in background until the driver is ready
+	if (this->tr.getInfoReadingStatus()) {
+		this->infoTask();
+		if (!this->tr.getInfoReadingStatus()) {
+			this->finishInit();
+		}
+	}
+	this->driverRunning = false;
+}
+
+/**
+ * SPI master task, sends/receives SPI packet or polls SPI status of TR module
+ * @return Next SPI activity can follow immediately
+ */
+bool IQRFBase::spiTask() {
+	this->setUsCount1(micros());
+	this->statistics.masterState(this->spi.getMasterStatus(), this->getUsCount1());
+	// is anything to send in Tx buffer?
+	if (this->spi.getMasterStatus() != this->spi.masterStatuses::FREE) {
+		// failed packet waits for backoff of its retry policy
+		if (this->getByteCount() == 0 && (this->getUsCount1() - this->retryStartUs) < this->retryBackoff) {
+			return false;
+		}
+		// send 1 byte (or whole packet in burst mode) every defined time interval via SPI
+		if ((this->getUsCount1() - this->getUsCount0()) > this->spi.getBytePause()) {
+			if (this->spi.isBurstModeEnabled()) {
+				// send/receive whole packet via SPI
+				bool transferred = this->burstTransfer();
+				// reset counter
+				this->setUsCount0(micros());
+				return transferred;
+			} else {
 				// reset counter
-				_iqrf.setUsCount0(_iqrf.getUsCount1());
+				this->setUsCount0(this->getUsCount1());
+				if (this->getByteCount() == 0) {
+					this->frameStartUs = this->getUsCount1();
+					this->crc.begin(this->getPTYPE());
+				}
 				// send/receive 1 byte via SPI
-				_buffers.setRxData(_iqrf.getByteCount(), _iqSpi.transfer(_buffers.getTxData(_iqrf.getByteCount())));
+				this->buffers.setRxData(this->getByteCount(), this->iqSpi.transfer(this->buffers.getTxData(this->getByteCount())));
+				this->statistics.clocked(1);
+				// fold received data to CRCS while waiting for next byte
+				if (this->getByteCount() >= 2 && this->getByteCount() < this->dataLength + 2) {
+					this->crc.update(this->buffers.getRxData(this->getByteCount()));
+				}
 				// counts number of send/receive bytes, it must be zeroing on packet preparing
-				_iqrf.setByteCount(_iqrf.getByteCount() + 1);
+				this->setByteCount(this->getByteCount() + 1);
+				// TR module returned its SPI status on the command, do not transfer a packet it can not accept
+				if (this->getByteCount() == 1 && !this->checkFrameStart()) {
+					return false;
+				}
 				// pacLen contains length of whole packet it must be set on packet preparing sent everything? + buffer overflow protection
-				if (_iqrf.getByteCount() == _packets.getLength() || _iqrf.getByteCount() == PACKET_SIZE) {
-					// CS - deactive
-					//digitalWrite(TR_SS_PIN, HIGH);
-					// CRC ok
-					if ((_buffers.getRxData(dataLength + 3) == _spi.statuses::CRCM_OK) &&
-						_crc.check(_buffers.getRxBuffer(), dataLength, _iqrf.getPTYPE())) {
-						if (_spi.getMasterStatus() == _spi.masterStatuses::WRITE) {
-							_callbacks.callTxCallback(_packets.getId(), _packets.statuses::OK);
-						}
-						if (_spi.getMasterStatus() == _spi.masterStatuses::READ) {
-							_callbacks.callRxCallback();
-						}
-						_spi.setMasterStatus(_spi.masterStatuses::FREE);
-					} else { // CRC error
-						// rep_cnt - must be set on packet preparing
-						if (_iqrf.getAttepmtsCount() - 1) {
-							// another attempt to send data
-							_iqrf.setByteCount(0);
-						} else {
-							if (_spi.getMasterStatus() == _spi.masterStatuses::WRITE) {
-								_callbacks.callTxCallback(_packets.getId(), _packets.statuses::ERROR);
-							}
-							_spi.setMasterStatus(_spi.masterStatuses::FREE);
-						}
-					}
+				if (this->getByteCount() == this->packets.getLength() || this->getByteCount() == PACKET_SIZE) {
+					this->packetDone();
+					return this->spi.getMasterStatus() == this->spi.masterStatuses::FREE;
 				}
 			}
-		} else { // no data to send => SPI status will be updated every 10ms
-			if ((_iqrf.getUsCount1() - _iqrf.getUsCount0()) > (MICRO_SECOND / 100)) {
-				// reset counter
-				_iqrf.setUsCount0(_iqrf.getUsCount1());
-				// get SPI status of TR module
-				_spi.setStatus(_iqSpi.transfer(_spi.commands::CHECK));
-				// CS - deactive
-				//digitalWrite(TR_SS_PIN, HIGH);      
-				// if the status is dataready prepare packet to read it
-				if ((_spi.getStatus() & 0xC0) == 0x40) {
-					memset(_buffers.getTxBuffer(), 0, _buffers.getTxBufferSize());
-					// state 0x40 means 64B
-					if (_spi.getStatus() == 0x40) {
-						dataLength = 64;
-					} else {
-						// clear bit 7,6 - rest is length (from 1 to 63B)
-						dataLength = _spi.getStatus() & 0x3F;
+		}
+	} else { // no data to send => SPI status will be updated in adaptive interval
+		unsigned long elapsedUs = this->getUsCount1() - this->getUsCount0();
+		if (elapsedUs > this->spi.getBytePause() && this->polling.isDue(elapsedUs)) {
+			// reset counter
+			this->setUsCount0(this->getUsCount1());
+			// data ready signal is taken before the status is read, later signal triggers next poll
+			this->polling.polled();
+			// get SPI status of TR module
+			this->spi.setStatus(this->iqSpi.transfer(this->spi.commands::CHECK));
+			this->statistics.clocked(1);
+			this->statistics.polled(this->spi.getStatus());
+			// CS - deactive
+			//digitalWrite(TR_SS_PIN, HIGH);
+			// if the status is dataready prepare packet to read it
+			// Rx frame must be free, otherwise TR module keeps data until application releases one
+			if ((this->spi.getStatus() & 0xC0) == 0x40 && this->acquireRxFrame()) {
+				this->polling.noticed(this->getUsCount1(), elapsedUs);
+				memset(this->buffers.getTxBuffer(), 0, this->buffers.getTxBufferSize());
+				// state 0x40 means 64B
+				if (this->spi.getStatus() == 0x40) {
+					this->dataLength = 64;
+				} else {
+					// clear bit 7,6 - rest is length (from 1 to 63B)
+					this->dataLength = this->spi.getStatus() & 0x3F;
+				}
+				this->setPTYPE(this->dataLength);
+				this->buffers.setTxData(0, this->spi.commands::WR_RD);
+				this->buffers.setTxData(1, this->getPTYPE());
+				// CRC, data are zeros
+				this->buffers.setTxData(this->dataLength + 2, this->crc.calculate(this->spi.commands::WR_RD, this->getPTYPE(), 0));
+				// length of whole packet + (CMD, PTYPE, CRCM, 0)
+				this->packets.setLength(this->dataLength + 4);
+				// counter of sent bytes
+				this->setByteCount(0);
+				// number of attempts to send data
+				this->setAttepmtsCount(1);
+				this->retryBackoff = 0;
+				// reading from buffer COM of TR module
+				this->spi.setMasterStatus(this->spi.masterStatuses::READ);
+				// current SPI status must be updated
+				this->spi.setStatus(this->spi.statuses::DATA_TRANSFER);
+			}
+			// write only when TR module is ready, not when it is busy, its buffer is full or SPI does not work
+			if (!this->spi.getMasterStatus() && (this->spi.getStatus() == this->spi.statuses::COMMUNICATION_MODE ||
+				this->spi.getStatus() == this->spi.statuses::PROGRAMMING_MODE || this->spi.getStatus() == this->spi.statuses::DEBUG_MODE)) {
+				// check if packet to send ready and Rx frame is free
+				IQRFTxQueue *queue = this->nextTxQueue();
+				// packets which missed their deadline in Tx queue are not sent
+				while (queue != NULL && this->dropExpiredPacket(queue)) {
+					queue = this->nextTxQueue();
+				}
+				if (queue != NULL && this->buffers.acquireRxFrame()) {
+					packetBuffer_t *packet = queue->front();
+					memset(this->buffers.getTxBuffer(), 0, this->buffers.getTxBufferSize());
+					this->dataLength = packet->dataLength;
+					// PBYTE set bit7 - write to buffer COM of TR module
+					this->setPTYPE(this->dataLength | 0x80);
+					this->buffers.setTxData(0, packet->spiCmd);
+					if (this->buffers.getTxData(0) == this->spi.commands::MODULE_INFO && this->dataLength == 16) {
+						this->setPTYPE(0x10);
 					}
-					_iqrf.setPTYPE(dataLength);
-					_buffers.setTxData(0, _spi.commands::WR_RD);
-					_buffers.setTxData(1, _iqrf.getPTYPE());
-					// CRC
-					_buffers.setTxData(dataLength + 2, _crc.calculate(_buffers.getTxBuffer(), dataLength));
+					this->buffers.setTxData(1, this->getPTYPE());
+					memcpy(&this->buffers.getTxBuffer()[2], queue->getData(packet), this->dataLength);
+					// CRCM, data were folded when the packet was queued
+					this->buffers.setTxData(this->dataLength + 2, this->crc.calculate(packet->spiCmd, this->getPTYPE(), packet->dataCrc));
 					// length of whole packet + (CMD, PTYPE, CRCM, 0)
-					_packets.setLength(dataLength + 4);
+					this->packets.setLength(this->dataLength + 4);
+					// set actual TX packet ID
+					this->packets.setId(packet->packetId);
 					// counter of sent bytes
-					_iqrf.setByteCount(0);
+					this->setByteCount(0);
 					// number of attempts to send data
-					_iqrf.setAttepmtsCount(1);
-					// reading from buffer COM of TR module
-					_spi.setMasterStatus(_spi.masterStatuses::READ);
-					// current SPI status must be updated
-					_spi.setStatus(_spi.statuses::DATA_TRANSFER);
-				}
-				// if TR module ready and no data in module pending
-				if (!_spi.getMasterStatus()) {
-					// check if packet to send ready
-					if (packetBufferInPtr != packetBufferOutPtr) {
-						memset(_buffers.getTxBuffer(), 0, _buffers.getTxBufferSize());
-						dataLength = iqrfPacketBuffer[packetBufferOutPtr].dataLength;
-						// PBYTE set bit7 - write to buffer COM of TR module
-						_iqrf.setPTYPE(dataLength | 0x80);
-						_buffers.setTxData(0, iqrfPacketBuffer[packetBufferOutPtr].spiCmd);
-						if (_buffers.getTxData(0) == _spi.commands::MODULE_INFO && dataLength == 16) {
-							_iqrf.setPTYPE(0x10);
-						}
-						_buffers.setTxData(1, _iqrf.getPTYPE());
-						memcpy(&_buffers.getTxBuffer()[2], iqrfPacketBuffer[packetBufferOutPtr].dataBuffer, dataLength);
-						// CRCM
-						_buffers.setTxData(dataLength + 2, _crc.calculate(_buffers.getTxBuffer(), dataLength));
-						// length of whole packet + (CMD, PTYPE, CRCM, 0)
-						_packets.setLength(dataLength + 4);
-						// set actual TX packet ID
-						_packets.setId(iqrfPacketBuffer[packetBufferOutPtr].packetId);
-						// counter of sent bytes
-						_iqrf.setByteCount(0);
-						// number of attempts to send data
-						_iqrf.setAttepmtsCount(3);
-						// writing to buffer COM of TR module
-						_spi.setMasterStatus(_spi.masterStatuses::WRITE);
-						if (iqrfPacketBuffer[packetBufferOutPtr].unallocationFlag) {
-							// unallocate temporary TX data buffer
-							free(iqrfPacketBuffer[packetBufferOutPtr].dataBuffer);
-						}
-						if (++packetBufferOutPtr >= PACKET_BUFFER_SIZE) {
-							packetBufferOutPtr = 0;
+					this->txRetryPolicy = (packet->retryPolicy != NULL) ? packet->retryPolicy : this->retryPolicy;
+					this->txQueuedUs = packet->timestamp;
+					if (packet->attempts != 0) {
+						// packet aborted by not ready TR module continues with its remaining attempts
+						this->txStartUs = packet->startUs;
+						this->setAttepmtsCount(packet->attempts);
+					} else {
+						this->txStartUs = this->getUsCount1();
+						this->setAttepmtsCount(this->txRetryPolicy->getMaxAttempts());
+						if (queue == &this->txQueueHigh && !this->txQueue.isEmpty()) {
+							this->txHighInRow++;
+						} else {
+							this->txHighInRow = 0;
 						}
-						// current SPI status must be updated
-						_spi.setStatus(_spi.statuses::DATA_TRANSFER);
 					}
+					this->retryBackoff = 0;
+					// writing to buffer COM of TR module
+					this->spi.setMasterStatus(this->spi.masterStatuses::WRITE);
+					// packet stays in Tx queue until it is finished, so it can be started again after abort
+					this->txActiveQueue = queue;
+					// current SPI status must be updated
+					this->spi.setStatus(this->spi.statuses::DATA_TRANSFER);
 				}
 			}
+			// nothing to do, poll status less often
+			if (this->spi.getMasterStatus() == this->spi.masterStatuses::FREE) {
+				this->polling.idle();
+				return false;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Find free Rx frame for reading of data from TR module
+ * If Rx queue is full, the oldest queued frame is dropped
+ * @return Free Rx frame was found
+ */
+bool IQRFBase::acquireRxFrame() {
+	if (this->buffers.acquireRxFrame()) {
+		return true;
+	}
+	return this->buffers.isRxQueueEnabled() && this->buffers.dropRxFrame() && this->buffers.acquireRxFrame();
+}
+
+/**
+ * Wait for byte to byte pause from last SPI activity
+ */
+void IQRFBase::waitBytePause() {
+	unsigned long elapsedUs = micros() - this->getUsCount0();
+	if (elapsedUs <= this->spi.getBytePause()) {
+		delayMicroseconds(this->spi.getBytePause() - elapsedUs + 1);
+	}
+}
+
+/**
+ * Send/receive whole SPI packet in one call, byte to byte pause is kept inside the burst
+ * The command is sent first, rest of the packet follows only if SPI status of TR module allows it
+ * @return Packet was transferred, it was not aborted
+ */
+bool IQRFBase::burstTransfer() {
+	uint8_t first = this->getByteCount();
+	uint8_t length = this->packets.getLength();
+	if (length > PACKET_SIZE) {
+		length = PACKET_SIZE;
+	}
+	if (first == 0) {
+		this->frameStartUs = micros();
+		this->crc.begin(this->getPTYPE());
+		this->buffers.setRxData(0, this->iqSpi.transfer(this->buffers.getTxData(0)));
+		this->statistics.clocked(1);
+		this->setUsCount0(this->frameStartUs);
+		this->setByteCount(1);
+		if (!this->checkFrameStart()) {
+			return false;
 		}
+		first = 1;
+		this->waitBytePause();
+	}
+	if (first < length) {
+		// send/receive rest of packet with one SS assertion, received bytes are folded to CRCS during the transfer
+		uint8_t blockCrc = this->iqSpi.transferBlock(&this->buffers.getTxBuffer()[first], &this->buffers.getRxBuffer()[first], length - first, this->spi.getBytePause());
+		this->crc.update(this->buffers.getRxBuffer(), first, length, this->dataLength, blockCrc);
+		this->statistics.clocked(length - first);
+	}
+	this->setByteCount(length);
+	this->packetDone();
+	return true;
+}
+
+/**
+ * Check SPI status returned by TR module on the first byte of SPI packet
+ * Packet which TR module can not accept is aborted, so its retry does not wait for the whole packet
+ * @return Packet transfer can continue
+ */
+bool IQRFBase::checkFrameStart() {
+	uint8_t status = this->buffers.getRxData(0);
+	uint8_t result = this->spi.classifyStatus(status);
+	// data in TR module must be the same as announced by the last status check
+	if (result == this->spi.frameResults::FRAME_OK && this->spi.getMasterStatus() == this->spi.masterStatuses::READ &&
+		status != (this->dataLength == 64 ? 0x40 : (0x40 | this->dataLength))) {
+		result = this->spi.frameResults::FRAME_NOT_READY;
+	}
+	if (result == this->spi.frameResults::FRAME_OK) {
+		return true;
+	}
+	this->spi.setFrameResult(result);
+	this->spi.setStatus(status);
+	this->statistics.aborted();
+	this->polling.traffic();
+	if (this->spi.getMasterStatus() == this->spi.masterStatuses::READ) {
+		// data are read again after next SPI status check
+		this->spi.setMasterStatus(this->spi.masterStatuses::FREE);
+	} else if (result == this->spi.frameResults::FRAME_NO_MODULE) {
+		// SPI of TR module does not work, the abort costs an attempt
+		this->retryPacket();
 	} else {
-		// SPI master is disabled
-		_tr.controlTask();
+		// TR module is busy or not ready, packet is started again after next status check without losing an attempt
+		// held state is kept in the queue slot, the packet stays at the front of its Tx queue
+		packetBuffer_t *packet = this->txActiveQueue->front();
+		packet->attempts = this->getAttepmtsCount();
+		packet->startUs = this->txStartUs;
+		this->spi.setMasterStatus(this->spi.masterStatuses::FREE);
+	}
+	return false;
+}
+
+/**
+ * Check result of transferred SPI packet and call Rx/Tx callback
+ */
+void IQRFBase::packetDone() {
+	// CS - deactive
+	//digitalWrite(TR_SS_PIN, HIGH);
+	this->spi.setFrameTime(micros() - this->frameStartUs);
+	if (this->spi.isDrainModeEnabled()) {
+		// check SPI status again right after the packet
+		this->polling.pollNow();
+	} else {
+		this->polling.traffic();
+	}
+	// CRC ok
+	if ((this->buffers.getRxData(this->dataLength + 3) == this->spi.statuses::CRCM_OK) &&
+		this->crc.isValid(this->buffers.getRxData(this->dataLength + 2))) {
+		this->spi.setFrameResult(this->spi.frameResults::FRAME_OK);
+		if (this->spi.getMasterStatus() == this->spi.masterStatuses::WRITE) {
+			this->statistics.written();
+			if (this->tr.getInfoReadingStatus() && this->idfMode == idfModes::COM_MODE) {
+				// identification data in COM mode
+				this->tr.identify(&this->buffers.getRxBuffer()[2]);
+			}
+			if (this->tr.getInfoReadingStatus() && this->idfMode == idfModes::CACHE_CHECK &&
+				!this->tr.verifyInfo(&this->buffers.getRxBuffer()[2])) {
+				// TR module was replaced, cached info is not valid
+				this->idfMode = idfModes::CACHE_MISMATCH;
+			}
+			this->txDone(this->packets.statuses::OK);
+		}
+		if (this->spi.getMasterStatus() == this->spi.masterStatuses::READ) {
+			this->statistics.read();
+			if (this->tr.getInfoReadingStatus() && this->idfMode == idfModes::PGM_MODE) {
+				// identification data in PGM mode
+				this->tr.identify(&this->buffers.getRxBuffer()[2]);
+			} else if (this->buffers.isRxQueueEnabled()) {
+				// application reads the frame later by IQRF::receive()
+				this->buffers.queueRxFrame(this->dataLength, micros());
+			} else if (this->callbacks.hasRxViewCallback()) {
+				// Rx frame is held until application releases it
+				this->callbacks.callRxViewCallback(&this->buffers.holdRxFrame()[2], this->dataLength);
+			} else {
+				this->callbacks.callRxCallback();
+			}
+		}
+		this->spi.setMasterStatus(this->spi.masterStatuses::FREE);
+	} else { // CRC error
+		if (this->buffers.getRxData(this->dataLength + 3) != this->spi.statuses::CRCM_OK) {
+			this->statistics.crcmError();
+		} else {
+			this->statistics.crcsError();
+		}
+		this->spi.setFrameResult(this->spi.frameResults::FRAME_CRC_ERROR);
+		this->retryPacket();
 	}
 }
 
 /**
- * Function is usually called inside the callback function, whitch is called when the driver receives data from TR module
- * @param dataBuffer Pointer to my buffer, to which I want to load data received from the TR module
- * @param dataLength Number of bytes I want to read
+ * Prepare another attempt to transfer failed SPI packet or report the failure
+ * Tx packet is sent again after backoff of its retry policy until attempts run out or its deadline elapses
  */
-void IQRF_GetRxData(uint8_t *dataBuffer, uint8_t dataLength) {
-	memcpy(dataBuffer, &_buffers.getRxBuffer()[2], dataLength);
+void IQRFBase::retryPacket() {
+	// rep_cnt - must be set on packet preparing
+	uint8_t attempts = this->getAttepmtsCount();
+	if (this->spi.getMasterStatus() == this->spi.masterStatuses::WRITE) {
+		if (this->txRetryPolicy->isExpired(this->txQueuedUs, micros())) {
+			this->txDone(this->packets.statuses::EXPIRED);
+		} else if (attempts > 1) {
+			// another attempt to send data
+			this->statistics.retry();
+			this->setAttepmtsCount(attempts - 1);
+			this->setByteCount(0);
+			this->retryStartUs = micros();
+			this->retryBackoff = this->txRetryPolicy->getBackoff(this->txRetryPolicy->getMaxAttempts() - attempts + 1);
+			return;
+		} else {
+			this->txDone(this->packets.statuses::ERROR);
+		}
+	}
+	this->spi.setMasterStatus(this->spi.masterStatuses::FREE);
 }
 
 /**
- * Read Module Info from TR module, uses SPI master implementation
+ * Drop the oldest packet of Tx queue if its deadline elapsed
+ * @param queue Tx queue
+ * @return Packet was dropped
  */
-void trInfoTask() {
-	static uint8_t dataToModule[16];
-	static uint8_t attempts;
-	static unsigned long timeoutMilli;
-	static uint8_t idfMode;
+bool IQRFBase::dropExpiredPacket(IQRFTxQueue *queue) {
+	packetBuffer_t *packet = queue->front();
+	IQRFRetryPolicy *retryPolicy = (packet->retryPolicy != NULL) ? packet->retryPolicy : this->retryPolicy;
+	unsigned long nowUs = micros();
+	if (!retryPolicy->isExpired(packet->timestamp, nowUs)) {
+		return false;
+	}
+	uint8_t packetId = packet->packetId;
+	this->tracker.record(packetId, this->packets.statuses::EXPIRED, packet->timestamp, nowUs, nowUs);
+	queue->pop();
+	this->callbacks.callTxCallback(packetId, this->packets.statuses::EXPIRED);
+	return true;
+}
 
-	static enum {
-		INIT_TASK = 0,
-		ENTER_PROG_MODE,
-		SEND_REQUEST,
-		WAIT_INFO,
-		DONE
-	} trInfoTaskStatus = INIT_TASK;
-	switch (trInfoTaskStatus) {
-		case INIT_TASK:
+/**
+ * Finish actual Tx packet, record its timestamps and call Tx callback
+ * @param result Tx result
+ */
+void IQRFBase::txDone(uint8_t result) {
+	// slot of finished packet is free for packets queued from Tx callback
+	this->txActiveQueue->pop();
+	this->tracker.record(this->packets.getId(), result, this->txQueuedUs, this->txStartUs, micros());
+	this->callbacks.callTxCallback(this->packets.getId(), result);
+}
+
+/**
+ * Read Module Info from TR module, uses SPI master implementation
+ */
+void IQRFBase::infoTask() {
+	switch (this->infoTaskStatus) {
+		case infoTaskStatuses::INIT_TASK:
 			// try enter to programming mode
-			attempts = 1;
-			// try to read idf in com mode
-			idfMode = 0;
-			// set call back function to process id data
-			_callbacks.setRxCallback(doNothingRx);
-			// set call back function after data were sent
-			_callbacks.setTxCallback(identifyTx);
-			trInfo.mcuType = _tr.mcuTypes::UNKNOWN;
-			memset(&dataToModule[0], 0, 16);
-			timeoutMilli = millis();
+			this->infoAttempts = 1;
+			// try to read idf in com mode, identification data are in Tx packet
+			this->idfMode = idfModes::COM_MODE;
+			this->tr.clearInfo();
+			this->infoTimeoutMs = millis();
+			if (this->infoCache != NULL) {
+				uint8_t cachedInfo[8];
+				if (this->infoCache->load(cachedInfo)) {
+					// warm boot - cached info is verified by module ID in COM mode
+					this->tr.restoreInfo(cachedInfo);
+					this->idfMode = idfModes::CACHE_CHECK;
+					this->infoTaskStatus = infoTaskStatuses::SEND_REQUEST;
+					break;
+				}
+			}
 			// next state - will read info in PGM mode or /* in COM mode */
-			trInfoTaskStatus = ENTER_PROG_MODE /* SEND_REQUEST */;
+			this->infoTaskStatus = infoTaskStatuses::ENTER_PROG_MODE /* SEND_REQUEST */;
 			break;
-		case ENTER_PROG_MODE:
-			_tr.enterProgramMode();
-			// try to read idf in pgm mode
-			idfMode = 1;
-			// set call back function to process id data
-			_callbacks.setRxCallback(identifyRx);
-			// set call back function after data were sent
-			_callbacks.setTxCallback(doNothingTx);
-			timeoutMilli = millis();
-			trInfoTaskStatus = SEND_REQUEST;
+		case infoTaskStatuses::ENTER_PROG_MODE:
+			this->tr.clearInfo();
+			this->tr.enterProgramMode();
+			// try to read idf in pgm mode, identification data are in Rx packet
+			this->idfMode = idfModes::PGM_MODE;
+			this->infoTimeoutMs = millis();
+			this->infoTaskStatus = infoTaskStatuses::SEND_REQUEST;
 			break;
-		case SEND_REQUEST:
-			if (_spi.getStatus() == _spi.statuses::COMMUNICATION_MODE &&
-				_spi.getMasterStatus() == _spi.masterStatuses::FREE) {
-				TR_SendSpiPacket(_spi.commands::MODULE_INFO, &dataToModule[0], 16, 0);
+		case infoTaskStatuses::SEND_REQUEST:
+			if (this->tr.isResetting() || this->tr.getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_VERIFY) {
+				// timeout starts when TR module is in programming mode, the entry can block one driver call for 500 ms
+				this->infoTimeoutMs = millis();
+				break;
+			}
+			if (this->spi.getStatus() == this->spi.statuses::COMMUNICATION_MODE &&
+				this->spi.getMasterStatus() == this->spi.masterStatuses::FREE) {
+				this->sendSpiPacket(this->spi.commands::MODULE_INFO, &infoRequest[0], 16, 0);
 				// initialize timeout timer
-				timeoutMilli = millis();
-				trInfoTaskStatus = WAIT_INFO;
+				this->infoTimeoutMs = millis();
+				this->infoTaskStatus = infoTaskStatuses::WAIT_INFO;
 			} else {
-				if (_spi.getStatus() == _spi.statuses::PROGRAMMING_MODE &&
-					_spi.getMasterStatus() == _spi.masterStatuses::FREE) {
-					TR_SendSpiPacket(_spi.commands::MODULE_INFO, &dataToModule[0], 1, 0);
+				if (this->spi.getStatus() == this->spi.statuses::PROGRAMMING_MODE &&
+					this->spi.getMasterStatus() == this->spi.masterStatuses::FREE) {
+					this->sendSpiPacket(this->spi.commands::MODULE_INFO, &infoRequest[0], 1, 0);
 					// initialize timeout timer
-					timeoutMilli = millis();
-					trInfoTaskStatus = WAIT_INFO;
+					this->infoTimeoutMs = millis();
+					this->infoTaskStatus = infoTaskStatuses::WAIT_INFO;
 				} else {
-					if (millis() - timeoutMilli >= MILLI_SECOND / 2) {
+					if (millis() - this->infoTimeoutMs >= MILLI_SECOND / 2 || this->tr.getProgramEntryStatus() == IQRFTR::programEntryStatuses::PGM_ENTRY_FAILED) {
 						// in a case, try it twice to enter programming mode
-						if (attempts) {
-							attempts--;
-							trInfoTaskStatus = ENTER_PROG_MODE;
+						if (this->infoAttempts) {
+							this->infoAttempts--;
+							this->infoTaskStatus = infoTaskStatuses::ENTER_PROG_MODE;
 						} else {
 							// TR module probably does not work
-							trInfoTaskStatus = DONE;
+							this->infoTaskStatus = infoTaskStatuses::DONE;
 						}
 					}
 				}
 			}
 			break;
 			// wait for info data from TR module
-		case WAIT_INFO:
-			if ((_tr.getInfoReadingStatus() == 1) || (millis() - timeoutMilli >= MILLI_SECOND / 2)) {
-				if (idfMode == 1) {
+		case infoTaskStatuses::WAIT_INFO:
+			if (this->idfMode == idfModes::CACHE_MISMATCH || (this->idfMode == idfModes::CACHE_CHECK &&
+				this->tr.getInfoReadingStatus() != 1 && millis() - this->infoTimeoutMs >= MILLI_SECOND / 2)) {
+				// cached info was not verified, read it in PGM mode
+				this->infoTaskStatus = infoTaskStatuses::ENTER_PROG_MODE;
+				break;
+			}
+			if ((this->tr.getInfoReadingStatus() == 1) || (millis() - this->infoTimeoutMs >= MILLI_SECOND / 2)) {
+				if (this->idfMode == idfModes::PGM_MODE) {
+					if (this->tr.getInfoReadingStatus() == 1 && this->infoCache != NULL) {
+						// next boot can skip PGM mode
+						this->infoCache->save(this->tr.getRawInfoData());
+					}
 					// send end of PGM mode packet
-					TR_SendSpiPacket(_spi.commands::EEPROM_PGM, (uint8_t *) & endPgmMode[0], 3, 0);
+					this->endProgramMode();
 				}
 				// next state
-				trInfoTaskStatus = DONE;
+				this->infoTaskStatus = infoTaskStatuses::DONE;
 			}
 			break;
 			// the task is finished
-		case DONE:
+		case infoTaskStatuses::DONE:
 			// if no packet is pending to send to TR module
-			if (packetBufferInPtr == packetBufferOutPtr &&
-				_spi.getMasterStatus() == _spi.masterStatuses::FREE) {
-				_tr.setInfoReadingStatus(0);
+			if (this->txQueue.isEmpty() && this->txQueueHigh.isEmpty() &&
+				this->spi.getMasterStatus() == this->spi.masterStatuses::FREE) {
+				this->tr.setInfoReadingStatus(0);
 			}
 			break;
 	}
 }
 
 /**
- * Process identification data packet from TR module
+ * Call driver of all TR modules on the bus, or own driver if the TR module is not on a bus
+ * SPI pins are shared, so a TR module on the bus must not be driven outside of the bus schedule
+ * @return Driver was called, false if the bus is already driving (call from a callback)
+ */
+bool IQRFBase::driveBus() {
+	if (this->bus == NULL) {
+		this->driver();
+		return true;
+	}
+	if (this->bus->isRunning()) {
+		return false;
+	}
+	this->bus->driver();
+	return true;
+}
+
+/**
+ * Send end of programming mode packet, TR module returns to communication mode
+ * @return Packet ID (number 1-255) or 0 if the packet was rejected
  */
-void trIdentify() {
-	memcpy((uint8_t *) & trInfo.moduleInfoRawData, (uint8_t *) & _buffers.getRxBuffer()[2], 8);
-	trInfo.moduleId = (uint32_t) _buffers.getRxBuffer()[2] << 24 | (uint32_t) _buffers.getRxBuffer()[3] << 16 | (uint32_t) _buffers.getRxBuffer()[4] << 8 | _buffers.getRxBuffer()[5];
-	trInfo.osVersion = (uint16_t) (_buffers.getRxBuffer()[6] / 16) << 8 | (_buffers.getRxBuffer()[6] % 16);
-	trInfo.mcuType = _buffers.getRxBuffer()[7] & 0x07;
-	trInfo.fcc = (_buffers.getRxBuffer()[7] & 0x08) >> 3;
-	trInfo.moduleType = _buffers.getRxBuffer()[7] >> 4;
-	trInfo.osBuild = (uint16_t) _buffers.getRxBuffer()[9] << 8 | _buffers.getRxBuffer()[8];
-	_tr.identify();
+uint8_t IQRFBase::endProgramMode() {
+	return this->sendSpiPacket(this->spi.commands::EEPROM_PGM, &endPgmMode[0], 3, 0, this->packets.priorities::HIGH_PRIORITY);
 }
 
 /**
- * Prepare SPI packet to packet buffer
+ * Copy SPI packet to packet buffer
  * @param spiCmd Command that I want to send to TR module
- * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module
+ * @param dataBuffer Pointer to a buffer that contains data that I want to send to TR module, data are copied
  * @param dataLength Number of bytes to send
  * @param unallocationFlag If the dataBuffer is dynamically allocated using malloc function.
-   If you wish to unallocate buffer after data is sent, set the unallocationFlag to 1, otherwise to 0.
- * @return Packet ID
+   If you wish to unallocate buffer after data is copied, set the unallocationFlag to 1, otherwise to 0.
+   Buffer of rejected packet is not unallocated.
+ * @param priority Packet priority
+ * @param retryPolicy Retry policy of the packet or NULL for retry policy of the driver
+ * @return Packet ID (number 1-255) or 0 if the packet was rejected
  */
-uint8_t TR_SendSpiPacket(uint8_t spiCmd, uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag) {
-	iqrfPacketBuffer[packetBufferInPtr].packetId = _packets.getIdCount();
-	iqrfPacketBuffer[packetBufferInPtr].spiCmd = spiCmd;
-	iqrfPacketBuffer[packetBufferInPtr].dataBuffer = dataBuffer;
-	iqrfPacketBuffer[packetBufferInPtr].dataLength = dataLength;
-	iqrfPacketBuffer[packetBufferInPtr].unallocationFlag = unallocationFlag;
-	if (++packetBufferInPtr >= PACKET_BUFFER_SIZE) {
-		packetBufferInPtr = 0;
+uint8_t IQRFBase::sendSpiPacket(uint8_t spiCmd, const uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag, uint8_t priority, IQRFRetryPolicy *retryPolicy) {
+	if (dataLength == 0 || dataLength > PACKET_SIZE - 4) {
+		return 0;
+	}
+	IQRFTxQueue *queue = this->getTxQueue(priority);
+	if (!queue->canPush(dataLength)) {
+		switch (queue->getOverflowPolicy()) {
+			case IQRFTxQueue::overflowPolicies::BLOCK:
+				// driver must not be called from callback functions
+				if (!this->driverRunning) {
+					unsigned long blockStartMs = millis();
+					while (!queue->canPush(dataLength) && (millis() - blockStartMs) < queue->getBlockTimeout() && this->driveBus());
+				}
+				break;
+			case IQRFTxQueue::overflowPolicies::DROP_OLDEST:
+				while (!queue->canPush(dataLength) && this->dropOldestPacket(queue));
+				break;
+		}
+		if (!queue->canPush(dataLength)) {
+			queue->overflow();
+			return 0;
+		}
+	}
+	uint8_t packetId = this->packets.newId();
+	queue->push(packetId, spiCmd, dataBuffer, dataLength, this->crc.fold(dataBuffer, dataLength), retryPolicy, micros());
+	if (unallocationFlag) {
+		// data are copied, unallocate temporary TX data buffer
+		free((void *) dataBuffer);
+	}
+	// packet should be sent as soon as possible
+	this->polling.traffic();
+	return packetId;
+}
+
+/**
+ * Drop the oldest packet from full packet buffer, packet in transfer is not dropped
+ * @param queue Tx queue
+ * @return Packet was dropped
+ */
+bool IQRFBase::dropOldestPacket(IQRFTxQueue *queue) {
+	packetBuffer_t *packet = queue->front();
+	if (packet == NULL || (queue == this->txActiveQueue && this->spi.getMasterStatus() == this->spi.masterStatuses::WRITE)) {
+		return false;
+	}
+	uint8_t packetId = packet->packetId;
+	unsigned long nowUs = micros();
+	this->tracker.record(packetId, this->packets.statuses::DROPPED, packet->timestamp, nowUs, nowUs);
+	queue->pop();
+	queue->overflow();
+	this->callbacks.callTxCallback(packetId, this->packets.statuses::DROPPED);
+	return true;
+}
+
+/**
+ * Select Tx queue of next sent packet
+ * High priority packets go first, with non-zero weight a normal priority packet
+ * is sent after each weight high priority packets
+ * @return Tx queue or NULL if there is no packet to send
+ */
+IQRFTxQueue* IQRFBase::nextTxQueue() {
+	if (!this->txQueueHigh.isEmpty()) {
+		if (this->txQueue.isEmpty() || this->txQueueHigh.getWeight() == 0 || this->txHighInRow < this->txQueueHigh.getWeight()) {
+			return &this->txQueueHigh;
+		}
+	}
+	if (!this->txQueue.isEmpty()) {
+		return &this->txQueue;
 	}
+	return NULL;
 }
@@ -32,47 +32,26 @@
 #include <stdint.h>
 
 #include "CallbackFunctions.h"
-#include "IQRF.h"
+#include "IQRFBase.h"
+#include "IQRFBridge.h"
 #include "IQRFBuffers.h"
+#include "IQRFBus.h"
 #include "IQRFCallbacks.h"
 #include "IQRFCRC.h"
+#include "IQRFDpa.h"
+#include "IQRFEepromCache.h"
+#include "IQRFInfoCache.h"
+#include "IQRFMemoryDump.h"
 #include "IQRFPackets.h"
+#include "IQRFPolling.h"
+#include "IQRFProgrammer.h"
+#include "IQRFRetryPolicy.h"
 #include "IQRFSettings.h"
 #include "IQRFSPI.h"
+#include "IQRFStatistics.h"
 #include "IQRFTR.h"
+#include "IQRFTracker.h"
+#include "IQRFTxQueue.h"
 #include "IQSPI.h"
 
-/**
- * TR module info structure
- */
-typedef struct {
-	uint16_t osVersion; //!< OS version
-	uint16_t osBuild; //!< OS build
-	uint32_t moduleId; //!< Module ID
-	uint16_t mcuType; //!< MCU tyle
-	uint16_t moduleType; //!< Module type
-	uint16_t fcc; //!< FCC
-	uint8_t moduleInfoRawData[8]; //!< Raw data
-} trInfo_t;
-
-/**
- * Item of SPI TX packet buffer
- */
-typedef struct {
-	uint8_t packetId; //!< Packet ID
-	uint8_t spiCmd; //!< SPI command
-	uint8_t *dataBuffer; //!< Pointer to data buffrt
-	uint8_t dataLength; //!< Data lenght
-	uint8_t unallocationFlag; //!< Unallocation flag
-} packetBuffer_t;
-
-extern uint8_t dataLength;
-extern trInfo_t trInfo;
-
-void IQRF_Init(IQRFCallbacks::rxCallback_t rxCallback, IQRFCallbacks::txCallback_t txCallback);
-void IQRF_Driver();
-void IQRF_GetRxData(uint8_t *dataBuffer, uint8_t dataLength);
-uint8_t TR_SendSpiPacket(uint8_t spiCmd, uint8_t *dataBuffer, uint8_t dataLength, uint8_t unallocationFlag);
-void trIdentify();
-
 #endif